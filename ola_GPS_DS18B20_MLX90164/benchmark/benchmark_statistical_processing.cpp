@@ -0,0 +1,447 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "statistical_processing.h"
+
+#include "cortex_m4_model.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// host benchmark of the estimators of statistical_processing: the former n-sigma filters
+// (accurate_sigma_filter, float_sigma_filter) against sigma_filter, the one-pass
+// Streaming_Robust_Mean, and the order statistics (median, MAD filter, trimmed mean)
+//
+// each estimator runs on the same synthetic datasets, with a few outliers; the datasets
+// are the same on all hosts and at each run. The timings are host timings, only
+// meaningful relative to each other; the Artemis is estimated with the cycle count model
+// of cortex_m4_model.h, from the ops done per element by each estimator (counted by hand
+// from the code below and in statistical_processing, except the comparisons of the
+// selections, that are counted on each dataset). The passes are the element loads per
+// element, i.e. the passes over the input; a selection is a partial pass per partition.
+// The in place estimators work on a copy of the dataset, and the copy is timed and
+// counted too.
+// the error is against a long double computation of the same estimator; float_sigma_filter
+// uses the n-1 standard deviation, so may keep slightly different values than the
+// reference at the edge; Streaming_Robust_Mean is checked against the same streaming
+// estimator in long double, as its result depends on the order of the values. For integral types, the estimators round their result to the
+// nearest, so an error up to 0.5 is expected.
+// the last column is the error against the center of the good values of the dataset,
+// i.e. how well the estimator gets rid of the outliers.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static constexpr size_t number_of_datasets {1000};
+static constexpr size_t number_of_repetitions {20};
+static constexpr double n_sigma {2.0};
+
+// Streaming_Robust_Mean, as for the GNSS fixes in GNSS_Manager: the sigma used for the
+// rejection is at least 20 1e-7 degrees, and the first samples are always kept
+static constexpr long streaming_minimum_sigma {20};
+static constexpr size_t streaming_warmup_samples {5};
+
+// GNSS like: the fixes of GNSS_Manager, in 1e-7 degrees, 1.5 m noise; alternately a
+// latitude and a (negative) longitude dataset
+static constexpr size_t size_gnss {30};
+static constexpr double center_latitude {599400000.0};
+static constexpr double center_longitude {-1225000000.0};
+
+// DS18B20 like: a few seconds of readings, in celsius, 0.05 celsius noise; alternately in
+// air and in sea water
+static constexpr size_t size_temperature {64};
+static constexpr double center_air {21.3};
+static constexpr double center_sea_water {-1.8};
+
+// mt19937 is fully specified by the standard, but the std distributions are not: draw the
+// values with the transforms below, so that the datasets are the same on all hosts
+static std::mt19937 generator;
+
+// in (0, 1)
+static double uniform(void){
+    return (static_cast<double>(generator()) + 0.5) / 4294967296.0;
+}
+
+// Box-Muller
+static double normal(double std){
+    double const u1 = uniform();
+    double const u2 = uniform();
+    return std * std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+static double fill_gnss(etl::ivector<long> & vec, size_t index){
+    double const center = (index % 2 == 0) ? center_latitude : center_longitude;
+    vec.clear();
+    while (vec.size() < vec.capacity()){
+        double value = center + normal(150.0);
+        if (uniform() < 0.05){
+            value += (uniform() < 0.5 ? -1.0 : 1.0) * 20000.0;
+        }
+        vec.push_back(static_cast<long>(std::lround(value)));
+    }
+    return center;
+}
+
+static double fill_temperature(etl::ivector<float> & vec, size_t index){
+    double const center = (index % 2 == 0) ? center_air : center_sea_water;
+    vec.clear();
+    while (vec.size() < vec.capacity()){
+        double value = center + normal(0.05);
+        if (uniform() < 0.05){
+            value = 85.0;  // the DS18B20 power on value
+        }
+        vec.push_back(static_cast<float>(value));
+    }
+    return center;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// the long double references
+
+template <typename T>
+static long double reference_sigma_filter(etl::ivector<T> const & vec){
+    long double mean {0};
+    for (T const & value : vec){
+        mean += static_cast<long double>(value);
+    }
+    mean /= vec.size();
+
+    long double variance {0};
+    for (T const & value : vec){
+        variance += (static_cast<long double>(value) - mean) * (static_cast<long double>(value) - mean);
+    }
+    long double const max_distance = n_sigma * std::sqrt(variance / vec.size());
+
+    long double sum_kept {0};
+    size_t count_kept {0};
+    for (T const & value : vec){
+        if (std::fabs(static_cast<long double>(value) - mean) <= max_distance){
+            sum_kept += static_cast<long double>(value);
+            count_kept += 1;
+        }
+    }
+    return sum_kept / count_kept;
+}
+
+// the same updates as Streaming_Robust_Mean, see statistical_processing.h
+template <typename T>
+static long double reference_streaming_robust_mean(etl::ivector<T> const & vec){
+    size_t number_of_samples {0};
+    size_t number_of_rejected_samples {0};
+    long double sum_kept {0};
+    long double welford_mean {0};
+    long double welford_m2 {0};
+
+    auto const welford_update = [&](long double value){
+        size_t const n = number_of_samples + number_of_rejected_samples;
+        long double const delta = value - welford_mean;
+        welford_mean += delta / n;
+        welford_m2 += delta * (value - welford_mean);
+    };
+
+    for (T const & value : vec){
+        long double const crrt_value = static_cast<long double>(value);
+        if (number_of_samples >= streaming_warmup_samples){
+            long double const mean = sum_kept / number_of_samples;
+            size_t const n = number_of_samples + number_of_rejected_samples;
+            long double const std = (n < 2) ? 0.0L : std::sqrt(welford_m2 / n);
+            long double const max_distance = n_sigma * std::max(std, static_cast<long double>(streaming_minimum_sigma));
+            long double const distance = crrt_value - mean;
+            if (std::fabs(distance) > max_distance){
+                number_of_rejected_samples += 1;
+                welford_update(mean + std::max(-max_distance, std::min(max_distance, distance)));
+                continue;
+            }
+        }
+        number_of_samples += 1;
+        sum_kept += crrt_value;
+        welford_update(crrt_value);
+    }
+    return sum_kept / number_of_samples;
+}
+
+template <typename T>
+static std::vector<long double> sorted_copy(etl::ivector<T> const & vec){
+    std::vector<long double> values(vec.begin(), vec.end());
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+static long double reference_median_sorted(std::vector<long double> const & values){
+    size_t const n = values.size();
+    return (n % 2 == 1) ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+template <typename T>
+static long double reference_median(etl::ivector<T> const & vec){
+    return reference_median_sorted(sorted_copy(vec));
+}
+
+template <typename T>
+static long double reference_mad_filter(etl::ivector<T> const & vec){
+    std::vector<long double> const values = sorted_copy(vec);
+    long double const median_value = reference_median_sorted(values);
+    std::vector<long double> deviations;
+    for (long double const value : values){
+        deviations.push_back(std::fabs(value - median_value));
+    }
+    std::sort(deviations.begin(), deviations.end());
+    long double const max_distance = 3.0L * 1.4826L * reference_median_sorted(deviations);
+
+    long double sum_kept {0};
+    size_t count_kept {0};
+    for (long double const value : values){
+        if (std::fabs(value - median_value) <= max_distance){
+            sum_kept += value;
+            count_kept += 1;
+        }
+    }
+    return sum_kept / count_kept;
+}
+
+template <typename T>
+static long double reference_trimmed_mean(etl::ivector<T> const & vec){
+    std::vector<long double> const values = sorted_copy(vec);
+    size_t const number_to_trim = static_cast<size_t>(0.1f * values.size());
+    long double sum {0};
+    for (size_t ind=number_to_trim; ind<values.size()-number_to_trim; ind++){
+        sum += values[ind];
+    }
+    return sum / (values.size() - 2 * number_to_trim);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// the ops per element of each estimator on the Artemis, for cortex_m4_model.h; long is 32
+// bits there, Sum is int64_t for long, Real is float unless given.
+// {passes, int, int64, float, int64 to float, double conversions, double add, mul, div, compare}
+
+// 2 passes: (sign extension, offset, sum, l2f, mul, add), then (sign extension, offset,
+// l2f, sub, abs, vcmp, vmrs, sum, count)
+static Op_Mix const mix_sigma_filter_long {2, 5, 5, 6, 2};
+// same, in double: l2d, dmul, dadd, then l2d, dsub, dcmple
+static Op_Mix const mix_sigma_filter_long_double {2, 6, 5, 0, 0, 2, 2, 1, 0, 1};
+// 4 passes, all in double: (i2d, ddiv, dadd), (i2d, dsub, dmul, ddiv, dadd), (i2d, dsub,
+// dcmple, dadd), (i2d, dsub, dcmplt, sub, add)
+static Op_Mix const mix_accurate_sigma_filter_long {4, 4, 0, 0, 0, 4, 6, 1, 2, 2};
+// 2 passes: (sub, add, mul, add), then (sub, sub, abs, vcmp, vmrs, add, count)
+static Op_Mix const mix_sigma_filter_float {2, 1, 0, 10, 0};
+// 3 passes: (add), (sub, mul, add), (sub, abs, vcmp, vmrs, add, count)
+static Op_Mix const mix_float_sigma_filter {3, 1, 0, 9, 0};
+// 1 pass, for a sample past the warmup and kept (the outliers cost about the same):
+// is_outlier (sign extensions, offset, l2f, mean: l2f, u2f, vdiv; std: u2f, vdiv, vsqrt;
+// rejection distance: i2f, vmax, mul; sub, abs, vcmp, vmrs, counts and branches), then
+// push (sign extensions, offset, sum, count; Welford: l2f, u2f, sub, vdiv, add, sub, mul, add)
+static Op_Mix const mix_streaming_robust_mean_long {1, 14, 3, 17, 3, 0, 0, 0, 0, 0, 4};
+
+// the ops of the order statistics that depend on T
+template <typename T>
+struct Order_Statistics_Mixes;
+
+template <>
+struct Order_Statistics_Mixes<long> {
+    // copy to the work buffer: load, store
+    static constexpr Op_Mix copy {1, 1};
+    // one comparison of the selection: load, cmp, branch, amortized swap
+    static constexpr Op_Mix comparison {1, 3};
+    // one comparison of the MAD selection: twice (sign extension, shift, sub, l2f, abs),
+    // then vcmp, vmrs, branch
+    static constexpr Op_Mix deviation_comparison {1, 7, 2, 4, 2};
+    // the pass of the MAD filter: sign extension, shift, sub, l2f, abs, vcmp, vmrs, offset, sum, count
+    static constexpr Op_Mix mad_filter_pass {1, 4, 4, 3, 1};
+    // the pass of the trimmed mean, on the values kept: sign extension, offset, sum, l2f, mul, add
+    static constexpr Op_Mix trimmed_mean_pass {1, 2, 2, 2, 1};
+};
+
+template <>
+struct Order_Statistics_Mixes<float> {
+    static constexpr Op_Mix copy {1, 1};
+    // load, vcmp, vmrs, branch, amortized swap
+    static constexpr Op_Mix comparison {1, 2, 0, 2};
+    // twice (mul, sub, abs), then vcmp, vmrs, branch
+    static constexpr Op_Mix deviation_comparison {1, 1, 0, 8};
+    // mul, sub, abs, vcmp, vmrs, sub, add, count
+    static constexpr Op_Mix mad_filter_pass {1, 1, 0, 7};
+    // sub, add, mul, add
+    static constexpr Op_Mix trimmed_mean_pass {1, 0, 0, 4};
+};
+
+// the number of comparisons done by the same std::nth_element call as the estimators
+template <typename T, typename Less>
+static size_t count_nth_element(std::vector<T> & values, size_t first, size_t nth, size_t last, Less less){
+    size_t comparisons {0};
+    std::nth_element(values.begin() + first, values.begin() + nth, values.begin() + last,
+                     [&comparisons, &less](T a, T b){ comparisons += 1; return less(a, b); });
+    return comparisons;
+}
+
+// the comparisons of twice_median_in_place, with the values left as the estimator leaves
+// them; twice the median in long double
+template <typename T>
+static size_t count_twice_median(std::vector<T> & values, long double & twice_median){
+    size_t const n = values.size();
+    size_t comparisons = count_nth_element(values, 0, n / 2, n, [](T a, T b){ return a < b; });
+    twice_median = 2.0L * values[n / 2];
+    if (n % 2 == 0){
+        comparisons += n / 2 - 1;  // max_element
+        twice_median = static_cast<long double>(*std::max_element(values.begin(), values.begin() + n / 2)) + values[n / 2];
+    }
+    return comparisons;
+}
+
+template <typename T>
+static Op_Mix model_median(etl::ivector<T> const & vec){
+    std::vector<T> values(vec.begin(), vec.end());
+    long double twice_median {0};
+    size_t const comparisons = count_twice_median(values, twice_median);
+
+    Op_Mix mix = Order_Statistics_Mixes<T>::copy;
+    mix += Order_Statistics_Mixes<T>::comparison * (static_cast<double>(comparisons) / vec.size());
+    return mix;
+}
+
+template <typename T>
+static Op_Mix model_mad_filter(etl::ivector<T> const & vec){
+    size_t const n = vec.size();
+    std::vector<T> values(vec.begin(), vec.end());
+    long double twice_median {0};
+    size_t const comparisons = count_twice_median(values, twice_median);
+
+    auto const deviation_less = [twice_median](T a, T b){
+        return std::fabs(2.0L * a - twice_median) < std::fabs(2.0L * b - twice_median);
+    };
+    size_t deviation_comparisons = count_nth_element(values, 0, n / 2, n, deviation_less);
+    if (n % 2 == 0){
+        deviation_comparisons += n / 2 - 1;
+    }
+
+    Op_Mix mix = Order_Statistics_Mixes<T>::copy;
+    mix += Order_Statistics_Mixes<T>::comparison * (static_cast<double>(comparisons) / n);
+    mix += Order_Statistics_Mixes<T>::deviation_comparison * (static_cast<double>(deviation_comparisons) / n);
+    mix += Order_Statistics_Mixes<T>::mad_filter_pass;
+    return mix;
+}
+
+template <typename T>
+static Op_Mix model_trimmed_mean(etl::ivector<T> const & vec){
+    size_t const n = vec.size();
+    size_t const number_to_trim = static_cast<size_t>(0.1f * n);
+    std::vector<T> values(vec.begin(), vec.end());
+    auto const less = [](T a, T b){ return a < b; };
+    size_t comparisons = count_nth_element(values, 0, number_to_trim, n, less);
+    comparisons += count_nth_element(values, number_to_trim, n - number_to_trim, n, less);
+
+    Op_Mix mix = Order_Statistics_Mixes<T>::copy;
+    mix += Order_Statistics_Mixes<T>::comparison * (static_cast<double>(comparisons) / n);
+    mix += Order_Statistics_Mixes<T>::trimmed_mean_pass * (static_cast<double>(n - 2 * number_to_trim) / n);
+    return mix;
+}
+
+static auto constant_model(Op_Mix const & mix){
+    return [mix](auto const &){ return mix; };
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T, size_t N, typename Fill, typename Filter, typename Reference, typename Model>
+static void run(char const * name, Fill fill, Filter filter, Reference reference, Model model){
+    // the datasets are generated up front, so that only the filter is timed; the same ones
+    // for all the estimators
+    static etl::vector<T, N> datasets[number_of_datasets];
+    static double centers[number_of_datasets];
+    generator.seed(12345);
+    for (size_t ind=0; ind<number_of_datasets; ind++){
+        centers[ind] = fill(datasets[ind], ind);
+    }
+
+    volatile double sink {0};
+    auto const start = std::chrono::steady_clock::now();
+    for (size_t repetition=0; repetition<number_of_repetitions; repetition++){
+        for (etl::vector<T, N> const & crrt_dataset : datasets){
+            sink = sink + static_cast<double>(filter(crrt_dataset));
+        }
+    }
+    auto const stop = std::chrono::steady_clock::now();
+    double const ns_per_call = std::chrono::duration<double, std::nano>(stop - start).count() / (number_of_datasets * number_of_repetitions);
+
+    long double max_error {0};
+    long double max_error_center {0};
+    Op_Mix mean_mix;
+    for (size_t ind=0; ind<number_of_datasets; ind++){
+        long double const value = static_cast<long double>(filter(datasets[ind]));
+        max_error = std::max(max_error, std::fabs(value - reference(datasets[ind])));
+        max_error_center = std::max(max_error_center, std::fabs(value - static_cast<long double>(centers[ind])));
+        mean_mix += model(datasets[ind]) * (1.0 / number_of_datasets);
+    }
+
+    double const m4_cycles_per_element = cortex_m4_cycles(mean_mix);
+    double const m4_us_per_call = m4_cycles_per_element * N / cortex_m4_clock_mhz;
+
+    printf("%-36s %4zu %10.1f %10.2f %7.2f %10.0f %10.1f %13.6Lg %13.6Lg\n", name, N, ns_per_call, ns_per_call / N,
+           mean_mix.passes, m4_cycles_per_element, m4_us_per_call, max_error, max_error_center);
+}
+
+// the in place estimators reorder the values: work on a copy
+template <typename T, size_t N, typename Estimator>
+static auto on_copy(Estimator estimator){
+    return [estimator](etl::ivector<T> const & vec){
+        etl::vector<T, N> copy;
+        for (T const & value : vec){
+            copy.push_back(value);
+        }
+        return estimator(copy);
+    };
+}
+
+int main(void){
+    printf("%-36s %4s %10s %10s %7s %10s %10s %13s %13s\n", "estimator", "n", "ns/call", "ns/elem", "passes",
+           "M4 cyc/el", "M4 us/call", "max |error|", "max |center|");
+
+    auto const reference_gnss = reference_sigma_filter<long>;
+    auto const reference_temperature = reference_sigma_filter<float>;
+
+    run<long, size_gnss>("accurate_sigma_filter<long>", fill_gnss,
+        [](etl::ivector<long> const & vec){ return accurate_sigma_filter<long>(vec, n_sigma); },
+        reference_gnss, constant_model(mix_accurate_sigma_filter_long));
+    run<long, size_gnss>("sigma_filter<long>", fill_gnss,
+        [](etl::ivector<long> const & vec){ return sigma_filter<long>(vec, static_cast<float>(n_sigma)).mean; },
+        reference_gnss, constant_model(mix_sigma_filter_long));
+    run<long, size_gnss>("sigma_filter<long, int64_t, double>", fill_gnss,
+        [](etl::ivector<long> const & vec){ return sigma_filter<long, int64_t, double>(vec, n_sigma).mean; },
+        reference_gnss, constant_model(mix_sigma_filter_long_double));
+    run<long, size_gnss>("Streaming_Robust_Mean<long>", fill_gnss,
+        [](etl::ivector<long> const & vec){
+            Streaming_Robust_Mean<long> estimator {static_cast<float>(n_sigma), streaming_minimum_sigma, streaming_warmup_samples};
+            for (long const value : vec){
+                estimator.push_if_not_outlier(value);
+            }
+            return estimator.mean();
+        },
+        reference_streaming_robust_mean<long>, constant_model(mix_streaming_robust_mean_long));
+    run<long, size_gnss>("median_in_place<long>", fill_gnss,
+        on_copy<long, size_gnss>([](etl::ivector<long> & vec){ return median_in_place<long>(vec); }),
+        reference_median<long>, model_median<long>);
+    run<long, size_gnss>("mad_filter_in_place<long>", fill_gnss,
+        on_copy<long, size_gnss>([](etl::ivector<long> & vec){ return mad_filter_in_place<long>(vec).mean; }),
+        reference_mad_filter<long>, model_mad_filter<long>);
+    run<long, size_gnss>("trimmed_mean_in_place<long>", fill_gnss,
+        on_copy<long, size_gnss>([](etl::ivector<long> & vec){ return trimmed_mean_in_place<long>(vec).mean; }),
+        reference_trimmed_mean<long>, model_trimmed_mean<long>);
+
+    run<float, size_temperature>("float_sigma_filter", fill_temperature,
+        [](etl::ivector<float> const & vec){ return float_sigma_filter(vec, static_cast<float>(n_sigma)); },
+        reference_temperature, constant_model(mix_float_sigma_filter));
+    run<float, size_temperature>("sigma_filter<float>", fill_temperature,
+        [](etl::ivector<float> const & vec){ return sigma_filter<float>(vec, static_cast<float>(n_sigma)).mean; },
+        reference_temperature, constant_model(mix_sigma_filter_float));
+    run<float, size_temperature>("median_in_place<float>", fill_temperature,
+        on_copy<float, size_temperature>([](etl::ivector<float> & vec){ return median_in_place<float>(vec); }),
+        reference_median<float>, model_median<float>);
+    run<float, size_temperature>("mad_filter_in_place<float>", fill_temperature,
+        on_copy<float, size_temperature>([](etl::ivector<float> & vec){ return mad_filter_in_place<float>(vec).mean; }),
+        reference_mad_filter<float>, model_mad_filter<float>);
+    run<float, size_temperature>("trimmed_mean_in_place<float>", fill_temperature,
+        on_copy<float, size_temperature>([](etl::ivector<float> & vec){ return trimmed_mean_in_place<float>(vec).mean; }),
+        reference_trimmed_mean<float>, model_trimmed_mean<float>);
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#ifndef CORTEX_M4_MODEL_H
+#define CORTEX_M4_MODEL_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// a rough cycle count model of the Artemis (Apollo3, Cortex-M4F at 48 MHz), for the host
+// benchmarks
+//
+// the host timings do not tell how slow the code is on the Cortex-M4F: single precision is
+// in hardware, but double and the int64 <-> floating point conversions are calls to the
+// libgcc soft float routines, tens to hundreds of cycles each. The model counts the
+// operations done per element of the input, by kind, and weights them with the costs
+// below. The costs are typical figures for gcc -Os and libgcc on a Cortex-M4 with the
+// flash cache hit; they are estimates, good to maybe a factor 1.5, that only aim at
+// ranking the implementations and at giving the order of magnitude. The per call
+// constant (sqrt, divisions at the end) is left out: the model is per element.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct Op_Mix {
+    double passes {0};            // element loads, in number of passes over the input; each with the loop overhead
+    double int_ops {0};           // 32 bits integer ops (long is 32 bits on the Artemis), compare and branch
+    double int64_ops {0};         // 64 bits add / sub (adds + adc)
+    double float_ops {0};         // single precision add, mul, abs, vcmp / vmrs, int32 <-> float
+    double int64_to_float {0};    // __aeabi_l2f
+    double double_conversions {0};// __aeabi_i2d, __aeabi_l2d, __aeabi_d2iz
+    double double_add {0};        // __aeabi_dadd, __aeabi_dsub
+    double double_mul {0};        // __aeabi_dmul
+    double double_div {0};        // __aeabi_ddiv
+    double double_compare {0};    // __aeabi_dcmple, etc
+    double float_div {0};         // single precision vdiv, vsqrt
+
+    Op_Mix & operator+=(Op_Mix const & other){
+        passes += other.passes;
+        int_ops += other.int_ops;
+        int64_ops += other.int64_ops;
+        float_ops += other.float_ops;
+        int64_to_float += other.int64_to_float;
+        double_conversions += other.double_conversions;
+        double_add += other.double_add;
+        double_mul += other.double_mul;
+        double_div += other.double_div;
+        double_compare += other.double_compare;
+        float_div += other.float_div;
+        return *this;
+    }
+
+    Op_Mix operator*(double factor) const {
+        Op_Mix result;
+        result.passes = passes * factor;
+        result.int_ops = int_ops * factor;
+        result.int64_ops = int64_ops * factor;
+        result.float_ops = float_ops * factor;
+        result.int64_to_float = int64_to_float * factor;
+        result.double_conversions = double_conversions * factor;
+        result.double_add = double_add * factor;
+        result.double_mul = double_mul * factor;
+        result.double_div = double_div * factor;
+        result.double_compare = double_compare * factor;
+        result.float_div = float_div * factor;
+        return result;
+    }
+};
+
+// the cost, in cycles, of each kind of op
+static constexpr double cortex_m4_cycles_per_pass {4};  // ldr / vldr (2) + increment, compare, taken branch
+static constexpr double cortex_m4_cycles_per_int_op {1};
+static constexpr double cortex_m4_cycles_per_int64_op {2};
+static constexpr double cortex_m4_cycles_per_float_op {1};
+static constexpr double cortex_m4_cycles_per_int64_to_float {25};
+static constexpr double cortex_m4_cycles_per_double_conversion {25};
+static constexpr double cortex_m4_cycles_per_double_add {60};
+static constexpr double cortex_m4_cycles_per_double_mul {50};
+static constexpr double cortex_m4_cycles_per_double_div {170};
+static constexpr double cortex_m4_cycles_per_double_compare {25};
+static constexpr double cortex_m4_cycles_per_float_div {14};
+
+static constexpr double cortex_m4_clock_mhz {48};
+
+inline double cortex_m4_cycles(Op_Mix const & mix){
+    return mix.passes * cortex_m4_cycles_per_pass
+         + mix.int_ops * cortex_m4_cycles_per_int_op
+         + mix.int64_ops * cortex_m4_cycles_per_int64_op
+         + mix.float_ops * cortex_m4_cycles_per_float_op
+         + mix.int64_to_float * cortex_m4_cycles_per_int64_to_float
+         + mix.double_conversions * cortex_m4_cycles_per_double_conversion
+         + mix.double_add * cortex_m4_cycles_per_double_add
+         + mix.double_mul * cortex_m4_cycles_per_double_mul
+         + mix.double_div * cortex_m4_cycles_per_double_div
+         + mix.double_compare * cortex_m4_cycles_per_double_compare
+         + mix.float_div * cortex_m4_cycles_per_float_div;
+}
+
+#endif
@@ -0,0 +1,171 @@
+/******************************************************************************
+MLXTransport.cpp
+The SMBus transactions used by IRTherm, and the buses they can run on; see
+MLXTransport.h
+******************************************************************************/
+
+#include <MLXTransport.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// SoftWireArtemis
+
+bool MLXSoftWireTransport::begin(void)
+{
+	_i2cPort->begin();
+	return true;
+}
+
+void MLXSoftWireTransport::end(void)
+{
+	// release both lines, the pull ups keep them high
+	pinMode(SDA, INPUT);
+	pinMode(SCL, INPUT);
+}
+
+bool MLXSoftWireTransport::quickCommand(uint8_t address)
+{
+	_i2cPort->beginTransmission(address);
+	return (_i2cPort->endTransmission() == 0);
+}
+
+bool MLXSoftWireTransport::readBlock(uint8_t address, uint8_t command, uint8_t * data, size_t length)
+{
+	_i2cPort->beginTransmission(address);
+	_i2cPort->write(command);
+
+	// no stop: the read follows with a repeated start
+	if (_i2cPort->endTransmission(false) != 0)
+		return false;
+
+	if (_i2cPort->requestFrom(address, length, true) != length)
+		return false;
+
+	for (size_t i = 0; i < length; i++)
+		data[i] = (uint8_t)_i2cPort->read();
+
+	return true;
+}
+
+bool MLXSoftWireTransport::writeBlock(uint8_t address, const uint8_t * data, size_t length)
+{
+	_i2cPort->beginTransmission(address);
+	_i2cPort->write(data, length);
+	return (_i2cPort->endTransmission(true) == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Apollo3 IOM
+
+static am_hal_gpio_pincfg_t iomPinConfig(uint32_t funcSel)
+{
+	am_hal_gpio_pincfg_t pinConfig = {};
+	pinConfig.uFuncSel = funcSel;
+	pinConfig.ePullup = AM_HAL_GPIO_PIN_PULLUP_1_5K;
+	pinConfig.eDriveStrength = AM_HAL_GPIO_PIN_DRIVESTRENGTH_12MA;
+	pinConfig.eGPOutcfg = AM_HAL_GPIO_PIN_OUTCFG_OPENDRAIN;
+	pinConfig.uIOMnum = MLXIOMTransport::iomModule;
+	return pinConfig;
+}
+
+bool MLXIOMTransport::begin(void)
+{
+	if (_iomHandle != nullptr)
+		return true;
+
+	am_hal_iom_config_t iomConfig = {};
+	iomConfig.eInterfaceMode = AM_HAL_IOM_I2C_MODE;
+	iomConfig.ui32ClockFreq = AM_HAL_IOM_100KHZ; // the MLX90614 does at most 100 kHz, the SMBus maximum
+
+	if (am_hal_iom_initialize(iomModule, &_iomHandle) != AM_HAL_STATUS_SUCCESS)
+	{
+		// e.g. Wire1 still holds the IOM
+		_iomHandle = nullptr;
+		return false;
+	}
+
+	if ((am_hal_iom_power_ctrl(_iomHandle, AM_HAL_SYSCTRL_WAKE, false) != AM_HAL_STATUS_SUCCESS) ||
+		(am_hal_iom_configure(_iomHandle, &iomConfig) != AM_HAL_STATUS_SUCCESS) ||
+		(am_hal_iom_enable(_iomHandle) != AM_HAL_STATUS_SUCCESS))
+	{
+		am_hal_iom_uninitialize(_iomHandle);
+		_iomHandle = nullptr;
+		return false;
+	}
+
+	am_hal_gpio_pinconfig(padSCL, iomPinConfig(AM_HAL_PIN_8_M1SCL));
+	am_hal_gpio_pinconfig(padSDA, iomPinConfig(AM_HAL_PIN_9_M1SDAWIR3));
+
+	return true;
+}
+
+void MLXIOMTransport::end(void)
+{
+	if (_iomHandle == nullptr)
+		return;
+
+	am_hal_iom_disable(_iomHandle);
+	am_hal_iom_power_ctrl(_iomHandle, AM_HAL_SYSCTRL_DEEPSLEEP, false);
+	am_hal_iom_uninitialize(_iomHandle);
+	_iomHandle = nullptr;
+
+	// no pull ups to a sensor that is about to be powered off
+	am_hal_gpio_pinconfig(padSCL, g_AM_HAL_GPIO_DISABLE);
+	am_hal_gpio_pinconfig(padSDA, g_AM_HAL_GPIO_DISABLE);
+}
+
+bool MLXIOMTransport::quickCommand(uint8_t address)
+{
+	if (_iomHandle == nullptr)
+		return false;
+
+	am_hal_iom_transfer_t transfer = {};
+	transfer.uPeerInfo.ui32I2CDevAddr = address;
+	transfer.eDirection = AM_HAL_IOM_TX;
+	transfer.ui32NumBytes = 0;
+
+	return (am_hal_iom_blocking_transfer(_iomHandle, &transfer) == AM_HAL_STATUS_SUCCESS);
+}
+
+bool MLXIOMTransport::readBlock(uint8_t address, uint8_t command, uint8_t * data, size_t length)
+{
+	if ((_iomHandle == nullptr) || (length == 0) || (length > maxBlockLength))
+		return false;
+
+	uint32_t rxWords[maxBlockLength / 4] = {};
+
+	// the command is the offset: START, address + W, command, repeated START,
+	// address + R, the <length> bytes, STOP, all done by the IOM
+	am_hal_iom_transfer_t transfer = {};
+	transfer.uPeerInfo.ui32I2CDevAddr = address;
+	transfer.ui32InstrLen = 1;
+	transfer.ui32Instr = command;
+	transfer.eDirection = AM_HAL_IOM_RX;
+	transfer.ui32NumBytes = length;
+	transfer.pui32RxBuffer = rxWords;
+
+	if (am_hal_iom_blocking_transfer(_iomHandle, &transfer) != AM_HAL_STATUS_SUCCESS)
+		return false;
+
+	memcpy(data, rxWords, length);
+	return true;
+}
+
+bool MLXIOMTransport::writeBlock(uint8_t address, const uint8_t * data, size_t length)
+{
+	if ((_iomHandle == nullptr) || (length == 0) || (length > maxBlockLength + 1))
+		return false;
+
+	uint32_t txWords[maxBlockLength / 4] = {};
+	memcpy(txWords, data + 1, length - 1);
+
+	// the command byte is the offset, the rest is the payload
+	am_hal_iom_transfer_t transfer = {};
+	transfer.uPeerInfo.ui32I2CDevAddr = address;
+	transfer.ui32InstrLen = 1;
+	transfer.ui32Instr = data[0];
+	transfer.eDirection = AM_HAL_IOM_TX;
+	transfer.ui32NumBytes = length - 1;
+	transfer.pui32TxBuffer = txWords;
+
+	return (am_hal_iom_blocking_transfer(_iomHandle, &transfer) == AM_HAL_STATUS_SUCCESS);
+}
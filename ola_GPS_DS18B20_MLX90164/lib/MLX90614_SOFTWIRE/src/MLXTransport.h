@@ -0,0 +1,95 @@
+/******************************************************************************
+MLXTransport.h
+The SMBus transactions used by IRTherm, and the buses they can run on
+
+The MLX90614 is a SMBus device: a read word is the command byte, a repeated
+start, and the 2 data bytes followed by the PEC (a CRC-8 over the whole
+transaction), and the device drops a transaction if SCL is held for more than
+the SMBus timeout between the command and the repeated start. The Apollo3
+Arduino Wire library issues the command and the read as two IOM commands, with
+too much software in between (see Documents/I2C_Apollo3.pdf), hence the
+SoftWire port in this library.
+
+IRTherm computes and checks the PEC; a transport only moves the bytes, each
+transaction in one go:
+ - MLXSoftWireTransport: the bit banged SoftWireArtemis, on any pins
+ - MLXIOMTransport: the Apollo3 IOM hardware I2C, where the command byte is
+   sent as the IOM "offset" of the transfer: the IOM generates the repeated
+   start itself, and the CPU only fills / empties the FIFO
+******************************************************************************/
+
+#ifndef MLX_TRANSPORT_H
+#define MLX_TRANSPORT_H
+
+#include <Arduino.h>
+#include <defWireArtemis.h>
+
+#ifdef MLX_SOFTWireArtemis
+ #include <SoftWireArtemis/MLX_SoftWireArtemis.h>
+#else
+ #include <WireArtemis.h>
+#endif
+
+class MLXTransport
+{
+public:
+	// begin() takes the bus (pins, peripheral); end() releases it, so that
+	// other code can use the same pins / peripheral afterwards.
+	virtual bool begin(void) = 0;
+	virtual void end(void) = 0;
+
+	// quickCommand(<address>) sends the address only, and returns 1 if the
+	// device acknowledged it.
+	virtual bool quickCommand(uint8_t address) = 0;
+
+	// readBlock(<address>, <command>, <data>, <length>) writes the command
+	// byte, then reads <length> bytes after a repeated start.
+	// Returns 1 on success, 0 on failure (no acknowledge, bus error).
+	virtual bool readBlock(uint8_t address, uint8_t command, uint8_t * data, size_t length) = 0;
+
+	// writeBlock(<address>, <data>, <length>) writes the <length> bytes
+	// (command byte first), followed by a stop.
+	// Returns 1 on success, 0 on failure.
+	virtual bool writeBlock(uint8_t address, const uint8_t * data, size_t length) = 0;
+};
+
+class MLXSoftWireTransport : public MLXTransport
+{
+public:
+	explicit MLXSoftWireTransport(TwoWireArtemis & WireArtemisPort) : _i2cPort(&WireArtemisPort) {}
+
+	void setPort(TwoWireArtemis & WireArtemisPort) { _i2cPort = &WireArtemisPort; }
+
+	bool begin(void) override;
+	void end(void) override;
+	bool quickCommand(uint8_t address) override;
+	bool readBlock(uint8_t address, uint8_t command, uint8_t * data, size_t length) override;
+	bool writeBlock(uint8_t address, const uint8_t * data, size_t length) override;
+
+private:
+	TwoWireArtemis * _i2cPort;
+};
+
+// IOM1, i.e. the Qwiic port of the Artemis boards (SCL pad 8, SDA pad 9). The
+// Arduino Wire1 uses the same IOM: only one of them may hold it at a time,
+// end() gives it back.
+class MLXIOMTransport : public MLXTransport
+{
+public:
+	static constexpr uint32_t iomModule = 1;
+	static constexpr uint32_t padSCL = 8;
+	static constexpr uint32_t padSDA = 9;
+	// the IOM works on 32 bits words; the MLX90614 transactions are 4 bytes at most
+	static constexpr size_t maxBlockLength = 16;
+
+	bool begin(void) override;
+	void end(void) override;
+	bool quickCommand(uint8_t address) override;
+	bool readBlock(uint8_t address, uint8_t command, uint8_t * data, size_t length) override;
+	bool writeBlock(uint8_t address, const uint8_t * data, size_t length) override;
+
+private:
+	void * _iomHandle = nullptr;
+};
+
+#endif
@@ -40,75 +40,67 @@
 #if defined(MLX_SOFTWireArtemis)
 
 #include "MLX_twi.h"
+#include "MLX_twi_pins.h"
 
 unsigned int preferred_si2c_clock = 100000;
 uint8_t twi_dcount = 4;
 unsigned char twi_sda, twi_scl;
 static uint32_t twi_clockStretchLimit;
 
-#define SDA_LOW()   (SETLOW(twi_sda))
-#define SDA_HIGH()  (pinMode(twi_sda, INPUT))
-#define SDA_READ()  (digitalRead(twi_sda))
-#define SCL_LOW()   (SETLOW(twi_scl))
-#define SCL_HIGH()  (pinMode(twi_scl, INPUT_PULLUP))
-#define SCL_READ()  (digitalRead(twi_scl))
-#define SETLOW(p)   {digitalWrite(p, LOW); pinMode(p,OUTPUT);}
+// the lines are open drain GPIO driven through the registers, see MLX_twi_pins.h;
+// the pins are the SDA / SCL of defWireArtemis.h, fixed at compile time
+typedef TWIPins<SDA, SCL> Pins;
+
+#define SDA_LOW()   (Pins::sdaLow())
+#define SDA_HIGH()  (Pins::sdaHigh())
+#define SDA_READ()  (Pins::sdaRead())
+#define SCL_LOW()   (Pins::sclLow())
+#define SCL_HIGH()  (Pins::sclHigh())
+#define SCL_READ()  (Pins::sclRead())
 
 // fine tine the clock stretch so provided limit value leads to about 1us
+// (about 5 loops of SCL_READ() per us at 48 MHz)
 #define TWI_CLOCK_STRETCH_MULTIPLIER 5
 
 // l = level HIGH/LOW
-// This will prevent setting LOW or HIGH if already on that level
-// saves time and unnecessary line changes/ jitter
-uint8_t SdaStat = 0;
-static void SetSda(bool l){
-	if (l) {		
-		if (SdaStat != 1) {			// if not high
-			SDA_HIGH();
-			SdaStat = 1;
-		}
-	}
-	else {
-		if (SdaStat != 2) {			// if not low
-			SDA_LOW();
-			SdaStat = 2;
-		}
-	}
+// a single store either way, and setting the level it already has does not
+// change the line
+static inline void SetSda(bool l){
+	if (l) SDA_HIGH();
+	else SDA_LOW();
 }
 	
 TWI::TWI() {}
 
 void TWI::twi_setClock(unsigned int freq){
-		// Artemis V1 (1 = ~25-30Khz)
-    // UNOR4 WIFI (1 = ~35Khz )
-		twi_dcount = 1; 
-		return;
-		
-		// original calculation
-    if (freq <= 80000) twi_dcount = 6;       
-    else if (freq <= 100000) twi_dcount = 4; 
-    else twi_dcount = 1;     
-    
+    // twi_dcount is the half period in us: each bit is a low and a high
+    // phase of twi_dcount us, plus a few cycles for the edges, so that the
+    // clock stays just below freq: 100 kHz => 5, 400 kHz => 1
+    if (freq == 0) freq = preferred_si2c_clock;
+    unsigned long dcount = 500000UL / freq;
+    if (dcount == 0) dcount = 1;
+    if (dcount > 255) dcount = 255;
+    twi_dcount = dcount;
 }
 
 void TWI::twi_setClockStretchLimit(uint32_t limit){
   twi_clockStretchLimit = limit * TWI_CLOCK_STRETCH_MULTIPLIER;
 }
 
+// NOTE: sda and scl must be the SDA and SCL of defWireArtemis.h, the ones
+// the pin driver is built for
 void TWI::twi_init(unsigned char sda, unsigned char scl){
   twi_sda = sda;
   twi_scl = scl;
   
-  pinMode(twi_sda, INPUT_PULLUP);
-  pinMode(twi_scl, INPUT_PULLUP);
+  Pins::init();
 	
   twi_setClock(preferred_si2c_clock);
   twi_setClockStretchLimit(500);       // default value is ~500 uS
 }
 
 void TWI::twi_stop(void){
-  pinMode(twi_sda, INPUT);
-  pinMode(twi_scl, INPUT);
+  Pins::release();
 }
 
 /* usleep has an overhead to useconds
@@ -121,8 +113,10 @@ void TWI::twi_stop(void){
  * v = 1 =>  5,4 us => 185Khz
  * 
  * ABOVE NOT VALID FOR :
- * Artemis V1 (1 = 25-30Khz)
  * UNOR4 WIFI (1 = ~35Khz)
+ *
+ * Artemis V1: with the register pin driver the edges are a few cycles,
+ * and the period is 2 * v us (was 1 = 25-30Khz with digitalWrite)
  */
 static void twi_delay(uint8_t v){
 	delayMicroseconds((uint32_t) v);
@@ -164,6 +158,7 @@ static bool twi_write_bit(bool bit) {
   twi_delay(twi_dcount);
   SCL_HIGH();							 // clock
   while (SCL_READ() == 0 && (i++) < twi_clockStretchLimit); // Clock stretching
+  twi_delay(twi_dcount);	// high phase; was covered by the digitalWrite overhead
   return true;
 }
 
@@ -0,0 +1,64 @@
+/**
+ * SoftWireArtemis pin driver for the Apollo3
+ *
+ * The bus lines are open drain outputs of the Apollo3 GPIO, with the input
+ * enabled: a line is pulled low by clearing its output bit and released
+ * (pulled up) by setting it, each a single store to the GPIO WTCx / WTSx
+ * register, and read back with a single load of RDx. The pads are template
+ * parameters, so that the masks and registers are known at compile time and
+ * no pin lookup / pad reconfiguration (pinMode, digitalWrite, digitalRead)
+ * is done at each edge.
+ *
+ * The pads are configured once in init(); release() gives them back as
+ * inputs, for pinMode / digitalWrite to be used again (e.g. the MLX90614
+ * sleep and wake sequences).
+ *
+ * NOTE: these are Apollo3 pad numbers; on the Artemis boards the Arduino
+ * pin numbers are the pad numbers.
+ */
+
+#ifndef MLX_TWI_PINS_H
+#define MLX_TWI_PINS_H
+
+#include "Arduino.h"
+
+template <uint32_t padSDA, uint32_t padSCL>
+class TWIPins
+{
+	public:
+		static void init(void){
+			// released before being made outputs, so that the lines do not glitch low
+			am_hal_gpio_output_set(padSDA);
+			am_hal_gpio_output_set(padSCL);
+			am_hal_gpio_pinconfig(padSDA, openDrainConfig());
+			am_hal_gpio_pinconfig(padSCL, openDrainConfig());
+		}
+
+		static void release(void){
+			pinMode(padSDA, INPUT);
+			pinMode(padSCL, INPUT);
+		}
+
+		static inline void sdaLow(void)   { am_hal_gpio_output_clear(padSDA); }
+		static inline void sdaHigh(void)  { am_hal_gpio_output_set(padSDA); }
+		static inline bool sdaRead(void)  { return am_hal_gpio_input_read(padSDA); }
+		static inline void sclLow(void)   { am_hal_gpio_output_clear(padSCL); }
+		static inline void sclHigh(void)  { am_hal_gpio_output_set(padSCL); }
+		static inline bool sclRead(void)  { return am_hal_gpio_input_read(padSCL); }
+
+	private:
+		// the GPIO function is 3 on all the Apollo3 pads
+		static constexpr uint32_t gpioFuncSel = 3;
+
+		static am_hal_gpio_pincfg_t openDrainConfig(void){
+			am_hal_gpio_pincfg_t pinConfig = {};
+			pinConfig.uFuncSel = gpioFuncSel;
+			pinConfig.ePullup = AM_HAL_GPIO_PIN_PULLUP_WEAK; // the Qwiic boards have their own pull ups
+			pinConfig.eDriveStrength = AM_HAL_GPIO_PIN_DRIVESTRENGTH_12MA;
+			pinConfig.eGPOutcfg = AM_HAL_GPIO_PIN_OUTCFG_OPENDRAIN;
+			pinConfig.eGPInput = AM_HAL_GPIO_PIN_INPUT_ENABLE;
+			return pinConfig;
+		}
+};
+
+#endif  // MLX_TWI_PINS_H
@@ -16,10 +16,11 @@ SparkFun IR Thermometer Evaluation Board - MLX90614
 
 #include <SparkFunMLX90614.h>
 
-IRTherm::IRTherm()
+IRTherm::IRTherm() : _softWireTransport(WireArtemis)
 {
 	// Set initial values for all private member variables
 	_deviceAddress = 0;
+	_transport = &_softWireTransport;
 	_defaultUnit = TEMP_C;
 	_rawObject = 0;
 	_rawAmbient = 0;
@@ -29,19 +30,23 @@ IRTherm::IRTherm()
 }
 
 bool IRTherm::begin(uint8_t address, TwoWireArtemis &WireArtemisPort)
+{
+	_softWireTransport.setPort(WireArtemisPort);
+
+	return (begin(address, _softWireTransport));
+}
+
+bool IRTherm::begin(uint8_t address, MLXTransport &transport)
 {
 	_deviceAddress = address; // Store the address in a private member
-	_i2cPort = &WireArtemisPort;
+	_transport = &transport;
 
 	return (isConnected());
 }
 
 bool IRTherm::isConnected()
 {
-	_i2cPort->beginTransmission(_deviceAddress);
-	if (_i2cPort->endTransmission() == 0)
-		return true;
-	return false;
+	return _transport->quickCommand(_deviceAddress);
 }
 
 void IRTherm::setUnit(temperature_units unit)
@@ -52,12 +57,40 @@ void IRTherm::setUnit(temperature_units unit)
 bool IRTherm::read()
 {
 	// read both the object and ambient temperature values
-	if (readObject() && readAmbient())
-	{
-		// If the reads succeeded, return success
-		return true;
-	}
-	return false; // Else return fail
+	IRThermRaw raw;
+	return readRaw(&raw);
+}
+
+bool IRTherm::readRaw(IRThermRaw * raw, bool object2)
+{
+	int16_t rawAmb, rawObj, rawObj2 = 0;
+
+	// one read word per register, with no processing in between
+	if (!I2CReadWord(MLX90614_REGISTER_TA, &rawAmb))
+		return false;
+	if (!I2CReadWord(MLX90614_REGISTER_TOBJ1, &rawObj))
+		return false;
+	if (object2 && !I2CReadWord(MLX90614_REGISTER_TOBJ2, &rawObj2))
+		return false;
+
+	if ((rawObj & 0x8000) || (rawObj2 & 0x8000)) // If there was a flag error
+		return false;
+
+	_rawAmbient = rawAmb;
+	_rawObject = rawObj;
+	if (object2)
+		_rawObject2 = rawObj2;
+
+	raw->ambient = rawAmb;
+	raw->object1 = rawObj;
+	raw->object2 = rawObj2;
+	return true;
+}
+
+float IRTherm::rawToCelsius(int16_t raw)
+{
+	// 0.02 degK / bit; float constants, the Cortex-M4F FPU is single precision
+	return float(raw) * 0.02f - 273.15f;
 }
 
 bool IRTherm::readRange()
@@ -209,6 +242,17 @@ float IRTherm::readEmissivity()
 	return 0; // Else return fail
 }
 
+bool IRTherm::readConfig(uint16_t * config)
+{
+	int16_t configRegister;
+	if (I2CReadWord(MLX90614_REGISTER_CONFIG, &configRegister))
+	{
+		*config = (uint16_t)configRegister;
+		return true;
+	}
+	return false;
+}
+
 uint8_t IRTherm::readAddress()
 {
 	int16_t tempAdd;
@@ -273,10 +317,11 @@ void IRTherm::sleep()
 	crc = crc8(crc, MLX90614_REGISTER_SLEEP);
 
 	// Manually send the sleep command:
-	_i2cPort->beginTransmission(_deviceAddress);
-	_i2cPort->write(MLX90614_REGISTER_SLEEP);
-	_i2cPort->write(crc);
-	_i2cPort->endTransmission(true);
+	uint8_t command[2] = {MLX90614_REGISTER_SLEEP, crc};
+	_transport->writeBlock(_deviceAddress, command, 2);
+
+	// Release the bus to drive the pins directly
+	_transport->end();
 
 	// Set the SCL pin LOW, and SDA pin HIGH (should be pulled up)
 	pinMode(SCL, OUTPUT);
@@ -287,7 +332,7 @@ void IRTherm::sleep()
 void IRTherm::wake()
 {
 	// Wake operation from datasheet
-	_i2cPort->endTransmission(true); // stop i2c bus transmission BEFORE sending wake up request
+	_transport->end(); // release the bus BEFORE sending wake up request
 	pinMode(SCL, INPUT); // SCL high
 	pinMode(SDA, OUTPUT);
 	digitalWrite(SDA, LOW); // SDA low
@@ -299,7 +344,7 @@ void IRTherm::wake()
 	digitalWrite(SCL, LOW); // SCL low
 	delay(10); // Delay at least 1.44ms
 	pinMode(SCL, INPUT); // SCL high
-	_i2cPort->beginTransmission(_deviceAddress); // reactivate i2c bus transmission AFTER sending wake up request
+	_transport->begin(); // take the bus again AFTER sending wake up request
 }
 
 int16_t IRTherm::calcRawTemp(float calcTemp)
@@ -361,16 +406,14 @@ float IRTherm::calcTemperature(int16_t rawTemp)
 
 bool IRTherm::I2CReadWord(uint8_t reg, int16_t * dest)
 {
+	// command, repeated start, lsb, msb, pec in one transaction
+	uint8_t data[3];
+	if (!_transport->readBlock(_deviceAddress, reg, data, 3))
+		return false;
 
-	_i2cPort->beginTransmission(_deviceAddress);
-	_i2cPort->write(reg);
-
-	_i2cPort->endTransmission(false); // Send restart
-	_i2cPort->requestFrom(_deviceAddress, (uint8_t) 3); // added true
-
-	uint8_t lsb = _i2cPort->read();
-	uint8_t msb = _i2cPort->read();
-	uint8_t pec = _i2cPort->read();
+	uint8_t lsb = data[0];
+	uint8_t msb = data[1];
+	uint8_t pec = data[2];
 
 	uint8_t crc = crc8(0, (_deviceAddress << 1));
 	crc = crc8(crc, reg);
@@ -416,12 +459,10 @@ uint8_t IRTherm::I2CWriteWord(uint8_t reg, int16_t data)
 	crc = crc8(crc, lsb);
 	crc = crc8(crc, msb);
 
-	_i2cPort->beginTransmission(_deviceAddress);
-	_i2cPort->write(reg);
-	_i2cPort->write(lsb);
-	_i2cPort->write(msb);
-	_i2cPort->write(crc);
-	return _i2cPort->endTransmission(true);
+	uint8_t block[4] = {reg, lsb, msb, crc};
+	if (_transport->writeBlock(_deviceAddress, block, 4))
+		return 0;
+	return 1;
 }
 
 uint8_t IRTherm::crc8 (uint8_t inCrc, uint8_t inData)
@@ -45,6 +45,8 @@ SparkFun IR Thermometer Evaluation Board - MLX90614
 	#endif
 #endif // SOFTWireArtemis
 
+#include <MLXTransport.h>
+
 
 //////////////////////////////////
 // MLX90614 Default I2C Address //
@@ -79,6 +81,15 @@ typedef enum {
 	TEMP_F
 } temperature_units;
 
+// The raw RAM temperatures filled by readRaw(), as the MLX90614 stores
+// them: 0.02 K per LSB. object2 is only read on the dual IR sensor
+// versions, and is 0 otherwise.
+typedef struct {
+	int16_t ambient; // Ta
+	int16_t object1; // Tobj1
+	int16_t object2; // Tobj2
+} IRThermRaw;
+
 class IRTherm
 {
 public:
@@ -92,6 +103,11 @@ public:
 	// If no parameter is supplied, the default MLX90614 address is used.
 	bool begin(uint8_t address = MLX90614_DEFAULT_ADDRESS, TwoWireArtemis &WireArtemisPort = WireArtemis);
 
+	// begin(<address>, <transport>) does the same over another transport,
+	// e.g. the Apollo3 hardware I2C (MLXIOMTransport, see MLXTransport.h).
+	// The transport must have been started with its begin().
+	bool begin(uint8_t address, MLXTransport &transport);
+
 	bool isConnected();
 
 	// setUnit(<unit>) configures the units returned by the ambient(),
@@ -110,6 +126,18 @@ public:
 	// checksum value).
 	bool read(void);
 
+	// readRaw(<raw>, <object2>) reads Ta, Tobj1 and, if <object2>, Tobj2,
+	// back to back, and stores the raw values into <raw>: the MLX90614 has
+	// no block read, each is a read word with its own PEC. Nothing is
+	// converted; use rawToCelsius(), or object() / ambient() afterwards.
+	// It will return 1 only if all the words were read with a valid PEC
+	// and no object error flag; <raw> is left untouched otherwise.
+	bool readRaw(IRThermRaw * raw, bool object2 = false);
+
+	// rawToCelsius(<raw>) converts a raw RAM temperature to Celsius, in
+	// single precision.
+	static float rawToCelsius(int16_t raw);
+
 	// object() returns the MLX90614's most recently read object temperature
 	// after the read() function has returned successfully. The float value
 	// returned will be in the units specified by setUnit().
@@ -130,6 +158,11 @@ public:
 	// The function will return either 1 on success or 0 on failure.
 	uint8_t setEmissivity(float emis);
 
+	// readConfig(<config>) reads the MLX90614's Config Register 1 (IIR and FIR
+	// filters, number of IR sensors, etc) into <config>.
+	// The function returns 1 on success and 0 on failure.
+	bool readConfig(uint16_t * config);
+
 	// readAddress() returns the MLX90614's configured 7-bit I2C bus address.
 	// A value between 0x01 and 0x7F should be returned.
 	uint8_t readAddress();
@@ -174,7 +207,8 @@ public:
 
 private:
 	uint8_t _deviceAddress; // MLX90614's 7-bit I2C address
-	TwoWireArtemis *_i2cPort;
+	MLXTransport *_transport; // the bus all the transactions go through
+	MLXSoftWireTransport _softWireTransport; // used by begin(<address>, <WireArtemisPort>)
 	
 	temperature_units _defaultUnit; // Keeps track of configured temperature unit
 
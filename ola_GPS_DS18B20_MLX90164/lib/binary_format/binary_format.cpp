@@ -0,0 +1,35 @@
+#include "binary_format.h"
+
+#include "firmware_configuration.h"
+
+void binary_init_block_header(Binary_Block_Header & header){
+    memset(&header, 0, sizeof(Binary_Block_Header));
+
+    header.magic = binary_block_magic;
+    header.format_version = binary_format_version;
+
+    // commit_id is 40 hex chars; copy without the null terminator, the header was zeroed so a
+    // shorter id is padded with 0
+    size_t const commit_id_length = strnlen(commit_id, binary_commit_id_length);
+    memcpy(header.firmware_commit, commit_id, commit_id_length);
+}
+
+// nibble based table: only 64 bytes of flash, and 2 lookups per byte
+static constexpr uint32_t crc32_nibble_table[16] {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t binary_crc32_update(uint32_t crc, uint8_t const * data, size_t length){
+    crc = ~crc;
+
+    for (size_t ind=0; ind<length; ind++){
+        crc ^= data[ind];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0F];
+    }
+
+    return ~crc;
+}
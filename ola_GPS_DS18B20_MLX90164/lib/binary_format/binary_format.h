@@ -0,0 +1,132 @@
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+#include "Arduino.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// the binary format used to write data blocks to the SD card
+//
+// a block is made of:
+//   - one Binary_Block_Header
+//   - number_of_sections times:
+//       - one Binary_Section_Header
+//       - number_of_records records, each record_size bytes
+//   - one uint32_t CRC32 (zlib convention) of all the bytes above
+//
+// blocks are written one after the other, each block starting on a binary_block_alignment
+// boundary in the file; the gap between the end of a block and the start of the next one
+// is filled with zeros. This way, all the writes to the SD card are whole sectors.
+//
+// all values are little endian (native on the Artemis), and all structs are packed, so
+// that the host side decoder (tools/decode_binary_data.py) does not need to know anything
+// about the alignment rules of the compiler.
+// any change to the layout below MUST come with a bump of binary_format_version, and the
+// corresponding update of the host side decoder.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// "OLAD" when read as ASCII bytes from the file
+static constexpr uint32_t binary_block_magic {0x44414C4F};
+// version history:
+//   1: first version
+//   2: Binary_Thermistor_Record holds the raw DS18B20 reading (int16_t, 1/16 celsius)
+//      instead of a float in celsius
+//   3: the reserved field of the block header is the block_type; a boot block may hold
+//      a trace section, so a boot block is no longer a block with no sections
+static constexpr uint16_t binary_format_version {3};
+
+static constexpr size_t binary_commit_id_length {40};
+
+enum class Binary_Section_Type : uint16_t {
+    thermistors = 1,
+    mlx = 2,
+    power_profile = 3,
+    thermistor_statistics = 4,
+    trace = 5,
+};
+
+enum class Binary_Block_Type : uint16_t {
+    data = 0,
+    boot = 1,
+};
+
+struct __attribute__((packed)) Binary_Block_Header {
+    uint32_t magic;
+    uint16_t format_version;
+    uint16_t boot_number;
+    uint32_t block_length;        // total number of bytes in the block, header and CRC included
+    uint64_t posix_start;         // posix timestamp at the start of the acquisition
+    char firmware_commit[binary_commit_id_length];  // not null terminated if 40 chars long
+    uint16_t number_of_sections;
+    uint16_t block_type;          // a Binary_Block_Type; was reserved (0) before version 3
+};
+
+struct __attribute__((packed)) Binary_Section_Header {
+    uint16_t section_type;
+    uint16_t record_size;
+    uint32_t number_of_records;
+};
+
+struct __attribute__((packed)) Binary_Thermistor_Record {
+    uint64_t id;
+    int16_t raw;  // 1/16 celsius
+};
+
+struct __attribute__((packed)) Binary_MLX_Record {
+    uint32_t posix_timestamp;
+    float ir_temperature;
+    float sensor_temperature;
+};
+
+// one record per thermistor, see ThermistorStatistics in thermistors_manager.h; the raw
+// values are in 1/16 celsius counts
+struct __attribute__((packed)) Binary_Thermistor_Statistics_Record {
+    uint64_t id;
+    uint32_t count;
+    int32_t sum_raw;
+    int64_t sum_squares_raw;
+    int16_t min_raw;
+    int16_t max_raw;
+    uint32_t crc_failures;
+};
+
+// one record per statistics of the Power_Profiler, see power_profiler.h for the list; the
+// durations are in us, except for the wakeup to wakeup cycle that is in s
+struct __attribute__((packed)) Binary_Power_Profile_Record {
+    uint8_t statistics_index;
+    uint8_t reserved[3];
+    uint32_t last;
+    uint32_t count;
+    uint32_t mean;
+    uint32_t max;
+};
+
+// one record per event of the trace log, see trace_log.h
+struct __attribute__((packed)) Binary_Trace_Record {
+    uint32_t posix_timestamp;
+    uint16_t boot_number;
+    uint16_t event;
+    uint32_t arg;
+};
+
+// the decoder relies on these sizes; do not change them without a format version bump
+static_assert(sizeof(Binary_Block_Header) == 64, "unexpected Binary_Block_Header size");
+static_assert(sizeof(Binary_Section_Header) == 8, "unexpected Binary_Section_Header size");
+static_assert(sizeof(Binary_Thermistor_Record) == 10, "unexpected Binary_Thermistor_Record size");
+static_assert(sizeof(Binary_MLX_Record) == 12, "unexpected Binary_MLX_Record size");
+static_assert(sizeof(Binary_Power_Profile_Record) == 20, "unexpected Binary_Power_Profile_Record size");
+static_assert(sizeof(Binary_Thermistor_Statistics_Record) == 32, "unexpected Binary_Thermistor_Statistics_Record size");
+static_assert(sizeof(Binary_Trace_Record) == 12, "unexpected Binary_Trace_Record size");
+
+static constexpr size_t binary_block_crc_size {sizeof(uint32_t)};
+
+// the SD card sector size
+static constexpr size_t binary_block_alignment {512};
+
+// fill a header with the magic, version, and firmware commit; the caller fills the rest
+void binary_init_block_header(Binary_Block_Header & header);
+
+// CRC32 following the zlib convention, so that the host can check with zlib.crc32
+// start with crc = 0, and feed the successive chunks of data, passing the previous result
+uint32_t binary_crc32_update(uint32_t crc, uint8_t const * data, size_t length);
+
+#endif
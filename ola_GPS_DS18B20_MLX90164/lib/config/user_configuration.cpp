@@ -12,9 +12,78 @@ void print_sleep_configs(void){
     delay(10);
 }
 
+void print_sd_configs(void){
+    SERIAL_USB->println(F("-- sd config start --"));
+    PRINTLN_VAR(sd_log_data_binary);
+    SERIAL_USB->print(F("sd_file_mode: ")); SERIAL_USB->println(static_cast<int>(sd_file_mode));
+    PRINTLN_VAR(sd_preallocated_file_size_bytes);
+    PRINTLN_VAR(sd_log_power_profile);
+    SERIAL_USB->println(F("-- sd config end   --"));
+    delay(10);
+}
+
+void print_thermistors_configs(void){
+    SERIAL_USB->println(F("-- thermistors config start --"));
+    PRINTLN_VAR(thermistors_resolution_bits);
+    PRINTLN_VAR(thermistors_broadcast_conversion);
+    PRINTLN_VAR(thermistors_conversion_poll_interval_ms);
+    PRINTLN_VAR(thermistors_log_raw_readings);
+    PRINTLN_VAR(thermistors_cache_ids);
+    PRINTLN_VAR(thermistors_rescan_every_n_wakeups);
+    SERIAL_USB->println(F("-- thermistors config end   --"));
+    delay(10);
+}
+
+void print_gnss_configs(void){
+    SERIAL_USB->println(F("-- gnss config start --"));
+    PRINTLN_VAR(gnss_use_auto_pvt);
+    PRINTLN_VAR(gnss_navigation_epoch_ms);
+    PRINTLN_VAR(gnss_fix_target_standard_error);
+    PRINTLN_VAR(gnss_fix_minimum_number_of_fixes);
+    PRINTLN_VAR(gnss_fix_maximum_number_of_fixes);
+    PRINTLN_VAR(gnss_use_assistance);
+    PRINTLN_VAR(gnss_navigation_database_max_bytes);
+    PRINTLN_VAR(gnss_assistance_time_accuracy_s);
+    PRINTLN_VAR(gnss_assistance_position_accuracy_m);
+    SERIAL_USB->println(F("-- gnss config end   --"));
+    delay(10);
+}
+
+void print_mlx_configs(void){
+    SERIAL_USB->println(F("-- mlx config start --"));
+    PRINTLN_VAR(mlx_paced_readings);
+    PRINTLN_VAR(mlx_power_up_ms);
+    PRINTLN_VAR(mlx_measurement_period_fir_1024_ms);
+    PRINTLN_VAR(mlx_use_hardware_i2c);
+    SERIAL_USB->println(F("-- mlx config end   --"));
+    delay(10);
+}
+
+void print_trace_configs(void){
+    SERIAL_USB->println(F("-- trace config start --"));
+    PRINTLN_VAR(trace_log_enabled);
+    PRINTLN_VAR(trace_log_number_of_records);
+    PRINTLN_VAR(heap_guard_enabled);
+    SERIAL_USB->println(F("-- trace config end   --"));
+    delay(10);
+}
+
+void print_serial_configs(void){
+    SERIAL_USB->println(F("-- serial config start --"));
+    SERIAL_USB->print(F("serial_log_level: ")); SERIAL_USB->println(static_cast<int>(serial_log_level));
+    SERIAL_USB->println(F("-- serial config end   --"));
+    delay(10);
+}
+
 void print_all_user_configs(void){
     SERIAL_USB->println(F("***** all user configs start *****"));
     print_sleep_configs();
+    print_sd_configs();
+    print_thermistors_configs();
+    print_mlx_configs();
+    print_gnss_configs();
+    print_trace_configs();
+    print_serial_configs();
     SERIAL_USB->println(F("***** all user configs end   *****"));
     delay(10);
 }
\ No newline at end of file
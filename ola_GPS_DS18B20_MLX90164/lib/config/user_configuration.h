@@ -33,9 +33,198 @@ constexpr unsigned long default_error_sleep_seconds {6UL * 3600UL};
 void print_sleep_configs(void);
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// whether to use serial prints
+// SD card logging setup
 
-static constexpr bool USE_SERIAL_PRINT {true};
+// write the data as compact binary blocks (see binary_format.h, and the host side decoder
+// in tools/decode_binary_data.py), rather than as human readable ASCII; the binary
+// format is much cheaper to write, i.e. the board stays awake for a much shorter time
+constexpr bool sd_log_data_binary {true};
+
+// how the binary data are split into files:
+// - one_file_per_wakeup: a new BBBBB-YYYY-MM-DDTHH-MM-SS.bin file each time data are logged;
+//   each file costs a directory entry and a FAT chain, and the directory gets slower to
+//   use as the card fills up
+// - one_file_per_day: one preallocated BBBBB-YYYY-MM-DD-NN.bin file per boot and UTC day
+// - one_file_per_boot: one preallocated BBBBB-NN.bin file per boot
+// in the preallocated modes, each block is written in place at the end of the previous
+// one; NN is a rollover index, incremented when the preallocated file is full
+enum class SD_File_Mode : int {
+    one_file_per_wakeup = 0,
+    one_file_per_day = 1,
+    one_file_per_boot = 2,
+};
+constexpr SD_File_Mode sd_file_mode {SD_File_Mode::one_file_per_day};
+
+// how many bytes to preallocate for each file in the preallocated modes; a data block is
+// typically 2 to 3 sectors, i.e. about 100 blocks per day use about 150 kB
+constexpr uint32_t sd_preallocated_file_size_bytes {1UL * 1024UL * 1024UL};
+
+// the preallocated modes rely on the sector aligned binary blocks
+static_assert((sd_file_mode == SD_File_Mode::one_file_per_wakeup) || sd_log_data_binary,
+              "preallocated files are only available with binary logging");
+static_assert(sd_preallocated_file_size_bytes % 512 == 0, "preallocate whole sectors");
+
+// append the awake time, peripheral on time, and SD card busy time statistics (see
+// power_profiler.h) to each data record; costs 11 lines / 228 bytes per record
+constexpr bool sd_log_power_profile {true};
+
+void print_sd_configs(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// DS18B20 thermistors setup
+
+// the resolution of the thermistors, 9 to 12 bits; each bit less halves the conversion
+// time (750 ms at 12 bits, 94 ms at 9 bits) and doubles the quantization step (0.0625 C
+// at 12 bits, 0.5 C at 9 bits). Written to all the thermistors at each power up, see
+// Thermistors_Manager::set_resolution to change it at run time.
+constexpr uint8_t thermistors_resolution_bits {12};
+
+static_assert((thermistors_resolution_bits >= 9) && (thermistors_resolution_bits <= 12));
+
+// start the conversions of all the thermistors at once, with a single Skip ROM + Convert T
+// broadcast, and poll the bus until all the conversions are over, rather than addressing
+// each thermistor in turn and waiting for the worst case conversion time; a round of
+// readings then takes about 750 ms at 12 bits, whatever the number of thermistors on the
+// string. This relies on the thermistors being externally powered (PIN_DS18B20_PWR), as a
+// parasite powered DS18B20 cannot answer the read slots while converting.
+constexpr bool thermistors_broadcast_conversion {true};
+
+// how often to poll the bus for the end of the conversions, in broadcast mode
+constexpr unsigned long thermistors_conversion_poll_interval_ms {5UL};
+
+static_assert(thermistors_conversion_poll_interval_ms <= 100);  // do not lose too much time after the end of the conversions
+
+// the thermistor readings are accumulated on the fly into per thermistor statistics
+// (count, mean, standard deviation, min, max, CRC failures), that are logged for each
+// acquisition; set to also store and log every single reading (uses RAM and SD space
+// proportional to the number of readings)
+constexpr bool thermistors_log_raw_readings {false};
+
+// keep the list of thermistor IDs found by the 1-wire search in RAM (retained during
+// sleep), and reuse it at the next wakeups as long as all the thermistors on it still
+// answer; the full search, with its LED blinks, then only runs at boot, when a thermistor
+// stops answering, or every thermistors_rescan_every_n_wakeups wakeups (to find new ones)
+constexpr bool thermistors_cache_ids {true};
+constexpr unsigned int thermistors_rescan_every_n_wakeups {96};
+
+void print_thermistors_configs(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// MLX90614 IR thermometer setup
+
+// pace the readings on the sensor: the MLX90614 updates its RAM once per measurement
+// cycle, the length of which is set by the FIR filter, and its IIR filter mixes each new
+// measurement with the previous ones. The filter configuration is read from the sensor at
+// each start, and the readings are spaced by the time for the IIR filter to settle, so
+// that each reading is a new measurement; the MCU deep sleeps in between. Otherwise, wait
+// 1.5 s at power up and 1 s before each reading, awake.
+constexpr bool mlx_paced_readings {true};
+// from power up to the first result in RAM: Tvalid is 0.15 s in the datasheet, plus a
+// margin for the Qwiic power rail to rise
+constexpr unsigned long mlx_power_up_ms {250UL};
+// the measurement cycle with the factory FIR filter length (N = 1024) and a single IR
+// sensor; it scales with N and with the number of IR sensors, and varies with the
+// internal oscillator of each sensor
+constexpr unsigned long mlx_measurement_period_fir_1024_ms {100UL};
+// talk to the sensor through the Apollo3 hardware I2C of the Qwiic port (IOM1), that does
+// the SMBus repeated start itself, rather than through the bit banged SoftWireArtemis; if
+// the IOM cannot be started, or the sensor does not answer on it, fall back to SoftWire
+constexpr bool mlx_use_hardware_i2c {true};
+
+static_assert(mlx_power_up_ms >= 150UL);
+static_assert(mlx_measurement_period_fir_1024_ms >= 10UL);
+
+void print_mlx_configs(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// GNSS setup
+
+// use the u-blox periodic ("auto") NAV-PVT messages: the receiver sends one NAV-PVT per
+// navigation epoch, that is read and cached in one go, and the MCU deep sleeps between
+// epochs. Otherwise, poll the fix type every 500 ms while waiting for a fix, and then
+// each field with its own getter (each may poll a new NAV-PVT over I2C).
+constexpr bool gnss_use_auto_pvt {true};
+// the navigation epoch, i.e. the period of the NAV-PVT messages
+constexpr unsigned long gnss_navigation_epoch_ms {1000UL};
+
+static_assert(gnss_navigation_epoch_ms >= 100UL);  // the receivers do at most 10 Hz
+static_assert(gnss_navigation_epoch_ms <= 10000UL);
+
+// the fix pushed by get_and_push_fix is the robust mean of several fixes, updated at each
+// fix (see Streaming_Robust_Mean in statistical_processing.h), taking at most
+// gnss_fix_maximum_number_of_fixes within 60 seconds. The acquisition stops early once the
+// standard error of the mean of both lat and lon is below gnss_fix_target_standard_error,
+// in 1e-7 degrees (90 is about 1 m of latitude), with at least
+// gnss_fix_minimum_number_of_fixes; set the target to 0 to always take all the fixes.
+constexpr long gnss_fix_target_standard_error {90};
+constexpr size_t gnss_fix_minimum_number_of_fixes {5};
+constexpr size_t gnss_fix_maximum_number_of_fixes {30};
+
+static_assert(gnss_fix_minimum_number_of_fixes >= 2);  // no standard error with less
+static_assert(gnss_fix_minimum_number_of_fixes <= gnss_fix_maximum_number_of_fixes);
+
+// hot start assistance: the receiver is powered off between the wakeups, and loses its
+// navigation database (ephemeris, almanac, etc), so each fix is a cold start. If true, the
+// database is read (UBX-MGA-DBD) before the receiver is powered off, kept in the MCU SRAM
+// (retained in deep sleep), and pushed back at the next power up after the RTC time and
+// the last filtered position; the receiver can then hot start.
+constexpr bool gnss_use_assistance {true};
+// room for the database dump; a u-blox M8 with GPS and GLONASS needs a few kB. A dump
+// that does not fit is dropped.
+constexpr size_t gnss_navigation_database_max_bytes {10240};
+// the accuracy given with the RTC time: 1 s resolution, plus the drift since the last fix
+constexpr uint16_t gnss_assistance_time_accuracy_s {2};
+// the accuracy given with the last position: how far the logger may have moved since
+constexpr uint32_t gnss_assistance_position_accuracy_m {5000};
+
+void print_gnss_configs(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// trace log
+
+// keep a ring buffer of the last events (time, event, argument) in a part of the SRAM that
+// is not cleared at startup, so that it survives a watchdog reset; it is written to the SD
+// card by the next log_boot(), see trace_log.h. Recording an event is a few stores, so
+// this can stay on in the field.
+constexpr bool trace_log_enabled {true};
+// 12 bytes per record; must be a power of 2
+constexpr uint32_t trace_log_number_of_records {256};
+
+static_assert((trace_log_number_of_records & (trace_log_number_of_records - 1)) == 0,
+              "the trace log ring buffer size must be a power of 2");
+
+// count the heap allocations (malloc / calloc / realloc, wrapped at link time) made during
+// the MLX acquisition, and report them as a warning and a heap_allocation trace event; see
+// heap_guard.h. Counting is a test and an increment per allocation.
+constexpr bool heap_guard_enabled {true};
+
+void print_trace_configs(void);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// serial prints
+
+// the verbosity of the serial output, see log_utils.h; the messages above this level are
+// removed at compile time, so that they cost neither flash nor time (no formatting, no
+// UART) in the acquisition loops
+// - none: no serial output at all
+// - error, warning: only when something goes wrong; a good choice for deployments
+// - info: one line for each step of the wakeup
+// - debug: the details of each step (the thermistors addresses, the readings, etc)
+// - verbose: everything, including each scratchpad byte and each GNSS poll
+enum class Log_Level : int {
+    none = 0,
+    error = 1,
+    warning = 2,
+    info = 3,
+    debug = 4,
+    verbose = 5,
+};
+constexpr Log_Level serial_log_level {Log_Level::verbose};
+
+// whether to use the USB serial at all
+static constexpr bool USE_SERIAL_PRINT {serial_log_level != Log_Level::none};
+
+void print_serial_configs(void);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // print all configs
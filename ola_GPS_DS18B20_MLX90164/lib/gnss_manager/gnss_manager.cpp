@@ -4,37 +4,52 @@ SFE_UBLOX_GNSS gnss;
 
 GNSS_Manager gnss_manager;
 
+// the last periodic NAV-PVT message; the callback is called by gnss.checkCallbacks(), from
+// the main program, so the copy is never seen half written
+static UBX_NAV_PVT_data_t last_auto_pvt;
+static bool last_auto_pvt_fresh {false};
+
+void store_auto_pvt(UBX_NAV_PVT_data_t * pvt_data){
+    last_auto_pvt = *pvt_data;
+    last_auto_pvt_fresh = true;
+}
+
 void turn_gnss_on(void){
     pinMode(PIN_QWIIC_PWR, OUTPUT);
     digitalWrite(PIN_QWIIC_PWR, HIGH);
+    power_profiler.peripheral_on(Power_Peripheral::qwiic);
 }
 
 void turn_gnss_off(void){
     pinMode(PIN_QWIIC_PWR, OUTPUT);
     digitalWrite(PIN_QWIIC_PWR, LOW);
+    power_profiler.peripheral_off(Power_Peripheral::qwiic);
 }
 
 bool GNSS_Manager::get_a_fix(unsigned long timeout_seconds, bool set_RTC_time, bool perform_full_start, bool perform_full_stop){
   wdt.restart();
   good_fit = false;
 
-  SERIAL_USB->println(F("attempt gnss fix"));
+  LOG_PRINTLN(debug, F("attempt gnss fix"));
 
   if (perform_full_start){
     // power things up and connect to the GNSS; if fail several time, restart the board
     bool gnss_startup {false};
     for (int i=0; i<5; i++){
       Wire1.begin();
-      SERIAL_USB->println(F("Wire1 started"));
+      LOG_PRINTLN(debug, F("Wire1 started"));
       turn_gnss_on();
       delay(1000); // Give it time to power up
       wdt.restart();
 
-      SERIAL_USB->println(F("gnss powered up"));
-      SERIAL_USB->flush();
+      if constexpr (LOG_ENABLED(debug)){
+        SERIAL_USB->println(F("gnss powered up"));
+        SERIAL_USB->flush();
+      }
 
       if (!gnss.begin(Wire1)){
-        SERIAL_USB->println(F("problem starting GNSS"));
+        LOG_PRINTLN(warning, F("problem starting GNSS"));
+        trace_log.record(Trace_Event::gnss_start_failed, i);
         
         // power things down
         turn_gnss_off();
@@ -43,7 +58,7 @@ bool GNSS_Manager::get_a_fix(unsigned long timeout_seconds, bool set_RTC_time, b
         continue;
       }
       else{
-        SERIAL_USB->println(F("success starting GNSS"));
+        LOG_PRINTLN(info, F("success starting GNSS"));
         gnss_startup = true;
         break;
       }
@@ -53,7 +68,8 @@ bool GNSS_Manager::get_a_fix(unsigned long timeout_seconds, bool set_RTC_time, b
     wdt.restart();
 
     if (!gnss_startup){
-      SERIAL_USB->println(F("failed to start GNSS; reboot"));
+      LOG_PRINTLN(error, F("failed to start GNSS; reboot"));
+      trace_log.record(Trace_Event::gnss_reboot);
       while (1){;}
     }
 
@@ -65,7 +81,21 @@ bool GNSS_Manager::get_a_fix(unsigned long timeout_seconds, bool set_RTC_time, b
     // Possible values are:
     // PORTABLE,STATIONARY,PEDESTRIAN,AUTOMOTIVE,SEA,AIRBORNE1g,AIRBORNE2g,AIRBORNE4g,WRIST,BIKE
     if (!gnss.setDynamicModel(DYN_MODEL_STATIONARY)){
-      SERIAL_USB->println(F("GNSS could not set dynamic model"));
+      LOG_PRINTLN(warning, F("GNSS could not set dynamic model"));
+    }
+
+    // periodic NAV-PVT messages; if the receiver does not take it, fall back to polling
+    auto_pvt_enabled = false;
+    if constexpr (gnss_use_auto_pvt){
+      wdt.restart();
+      auto_pvt_enabled = gnss.setMeasurementRate(gnss_navigation_epoch_ms) && gnss.setAutoPVTcallbackPtr(&store_auto_pvt);
+      if (!auto_pvt_enabled){
+        LOG_PRINTLN(warning, F("GNSS could not set auto PVT; poll"));
+      }
+    }
+
+    if constexpr (gnss_use_assistance){
+      push_assistance();
     }
 
     wdt.restart();
@@ -75,47 +105,46 @@ bool GNSS_Manager::get_a_fix(unsigned long timeout_seconds, bool set_RTC_time, b
   byte gnss_fix_status {0};
   wdt.restart();
 
-  SERIAL_USB->println(F("attempt GNSS fix, remaining time to fix timeout:"));
-  delay(5);
-  for (int i=0; i<timeout_seconds;i++){
-    SERIAL_USB->print(F("-"));
+  // a progress bar: the time to the fix timeout, and a dash for each poll
+  if constexpr (LOG_ENABLED(verbose)){
+    SERIAL_USB->println(F("attempt GNSS fix, remaining time to fix timeout:"));
+    delay(5);
+    for (unsigned long i=0; i<timeout_seconds; i++){
+      SERIAL_USB->print(F("-"));
+    }
+    SERIAL_USB->println();
+    delay(10);
   }
-  SERIAL_USB->println();
-  delay(10);
 
-  for (unsigned long start_millis=millis(); (gnss_fix_status != 3) && (millis() - start_millis < timeout_seconds * 1000UL); ){
-    wdt.restart();
-    SERIAL_USB->print(F("-"));
-    delay(500);
-    gnss_fix_status = gnss.getFixType();
+  if (auto_pvt_enabled){
+    gnss_fix_status = wait_for_fix_auto_pvt(timeout_seconds);
   }
-  SERIAL_USB->println();
+  else {
+    gnss_fix_status = wait_for_fix_polling(timeout_seconds);
+  }
+  LOG_PRINTLN(verbose);
 
   wdt.restart();
 
   if (gnss_fix_status == 3){
     // read the data and store it here
     good_fit = true;
-    milliseconds = gnss.getMillisecond();
-    second = gnss.getSecond();
-    minute = gnss.getMinute();
-    hour = gnss.getHour();
-    day = gnss.getDay();
-    month = gnss.getMonth();
-    year = gnss.getYear();
-    latitude = gnss.getLatitude();
-    longitude = gnss.getLongitude();
-    altitude = gnss.getAltitudeMSL();
-    speed = gnss.getGroundSpeed();
-    satellites = gnss.getSIV();
-    course = gnss.getHeading();
-    pdop = gnss.getPDOP();
-
-    SERIAL_USB->print(F("we got a gnss fix:"));
-    SERIAL_USB->print(year); SERIAL_USB->print(F("-")); SERIAL_USB->print(month); SERIAL_USB->print(F("-")); SERIAL_USB->print(day);
-      SERIAL_USB->print(F(" ")); SERIAL_USB->print(hour); SERIAL_USB->print(F(":")); SERIAL_USB->print(minute); SERIAL_USB->print(F(":"));
-      SERIAL_USB->print(second); SERIAL_USB->print(F(" ")); SERIAL_USB->print(latitude); SERIAL_USB->print(F(",")); SERIAL_USB->print(longitude);
-      SERIAL_USB->println();
+    if (auto_pvt_enabled){
+      read_fix_auto_pvt();
+    }
+    else {
+      read_fix_polling();
+    }
+
+    trace_log.record(Trace_Event::gnss_fix, satellites);
+
+    if constexpr (LOG_ENABLED(debug)){
+      SERIAL_USB->print(F("we got a gnss fix:"));
+      SERIAL_USB->print(year); SERIAL_USB->print(F("-")); SERIAL_USB->print(month); SERIAL_USB->print(F("-")); SERIAL_USB->print(day);
+        SERIAL_USB->print(F(" ")); SERIAL_USB->print(hour); SERIAL_USB->print(F(":")); SERIAL_USB->print(minute); SERIAL_USB->print(F(":"));
+        SERIAL_USB->print(second); SERIAL_USB->print(F(" ")); SERIAL_USB->print(latitude); SERIAL_USB->print(F(",")); SERIAL_USB->print(longitude);
+        SERIAL_USB->println();
+    }
 
     wdt.restart();
 
@@ -124,24 +153,31 @@ bool GNSS_Manager::get_a_fix(unsigned long timeout_seconds, bool set_RTC_time, b
       year, month, day, hour, minute, second
     );
 
-    SERIAL_USB->print(F("we computed a posix timestamp: ")); SERIAL_USB->println((unsigned long)common_working_posix_timestamp);
+    LOG_PRINT(debug, F("we computed a posix timestamp: ")); LOG_PRINTLN(debug, (unsigned long)common_working_posix_timestamp);
     
     posix_timestamp = common_working_posix_timestamp;
 
+    // main only calls get_a_fix: keep the last good fix for the next hot start;
+    // get_and_push_fix then replaces it with the filtered position
+    assistance_position = fix_information{posix_timestamp, latitude, longitude};
+    assistance_altitude = altitude;
+    assistance_position_valid = true;
+
     if (set_RTC_time){
       board_time_manager.set_posix_timestamp(common_working_posix_timestamp);
+      rtc_set_from_fix = true;
     }
   }
   else{
-    SERIAL_USB->println(F("GNSS timed out without fix"));
+    LOG_PRINTLN(warning, F("GNSS timed out without fix"));
+    trace_log.record(Trace_Event::gnss_timeout, timeout_seconds);
   }
 
   wdt.restart();
 
   // power things down
   if (perform_full_stop){
-    turn_gnss_off();
-    Wire1.end();
+    power_down(good_fit);
   }
 
   wdt.restart();
@@ -149,70 +185,248 @@ bool GNSS_Manager::get_a_fix(unsigned long timeout_seconds, bool set_RTC_time, b
   return good_fit;
 }
 
+byte GNSS_Manager::wait_for_fix_polling(unsigned long timeout_seconds){
+  byte gnss_fix_status {0};
+
+  for (unsigned long start_millis=millis(); (gnss_fix_status != 3) && (millis() - start_millis < timeout_seconds * 1000UL); ){
+    wdt.restart();
+    LOG_PRINT(verbose, F("-"));
+    delay(500);
+    gnss_fix_status = gnss.getFixType();
+  }
+
+  return gnss_fix_status;
+}
+
+byte GNSS_Manager::wait_for_fix_auto_pvt(unsigned long timeout_seconds){
+  byte gnss_fix_status {0};
+
+  // drop any message still queued in the receiver: the fix must be from a new epoch, so
+  // that the time set to the RTC is not stale
+  gnss.checkUblox();
+  gnss.checkCallbacks();
+  last_auto_pvt_fresh = false;
+
+  // the MCU sleeps most of the time, millis() does not count that
+  for (unsigned long start_millis=sleep_aware_millis(); (gnss_fix_status != 3) && (sleep_aware_millis() - start_millis < timeout_seconds * 1000UL); ){
+    wdt.restart();
+    gnss.checkUblox();
+    gnss.checkCallbacks();
+
+    if (!last_auto_pvt_fresh){
+      sleep_for_milliseconds(auto_pvt_check_interval_ms);
+      continue;
+    }
+
+    last_auto_pvt_fresh = false;
+    gnss_fix_status = last_auto_pvt.fixType;
+    LOG_PRINT(verbose, F("-"));
+
+    if (gnss_fix_status != 3){
+      // nothing new until the next epoch
+      sleep_for_milliseconds(gnss_navigation_epoch_ms - auto_pvt_wake_up_early_ms);
+    }
+  }
+
+  return gnss_fix_status;
+}
+
+void GNSS_Manager::read_fix_polling(void){
+  milliseconds = gnss.getMillisecond();
+  second = gnss.getSecond();
+  minute = gnss.getMinute();
+  hour = gnss.getHour();
+  day = gnss.getDay();
+  month = gnss.getMonth();
+  year = gnss.getYear();
+  latitude = gnss.getLatitude();
+  longitude = gnss.getLongitude();
+  altitude = gnss.getAltitudeMSL();
+  speed = gnss.getGroundSpeed();
+  satellites = gnss.getSIV();
+  course = gnss.getHeading();
+  pdop = gnss.getPDOP();
+}
+
+void GNSS_Manager::read_fix_auto_pvt(void){
+  // all from the same NAV-PVT message, no I2C transfer
+  milliseconds = last_auto_pvt.iTOW % 1000;
+  second = last_auto_pvt.sec;
+  minute = last_auto_pvt.min;
+  hour = last_auto_pvt.hour;
+  day = last_auto_pvt.day;
+  month = last_auto_pvt.month;
+  year = last_auto_pvt.year;
+  latitude = last_auto_pvt.lat;
+  longitude = last_auto_pvt.lon;
+  altitude = last_auto_pvt.hMSL;
+  speed = last_auto_pvt.gSpeed;
+  satellites = last_auto_pvt.numSV;
+  course = last_auto_pvt.headMot;
+  pdop = last_auto_pvt.pDOP;
+}
+
 bool GNSS_Manager::get_and_push_fix(unsigned long timeout_seconds){
   wdt.restart();
   
-  SERIAL_USB->println(F("start with GNSS buffer:"));
+  LOG_PRINTLN(info, F("start with GNSS buffer:"));
   
   if(get_a_fix(timeout_seconds, true, true, false)){
     number_of_GPS_fixes += 1;
 
-    // clear the accumulators
-    crrt_accumulator_latitude.clear();
-    crrt_accumulator_longitude.clear();
-    crrt_accumulator_posix_timestamp.clear();
+    // clear the estimators
+    estimator_latitude.clear();
+    estimator_longitude.clear();
+    estimator_posix_timestamp.clear();
 
     // push the current fix
-    crrt_accumulator_latitude.push_back(latitude);
-    crrt_accumulator_longitude.push_back(longitude);
-    crrt_accumulator_posix_timestamp.push_back(posix_timestamp);
+    push_fix_to_estimators();
 
     // to be on the safe side, get a few extra fixes, and do some filtering on it to keep only "good" fixes;
     // maybe this helps avoid the "bad fix" problems (?)
     wdt.restart();
-    delay(5000); // give a bit of time for the GPS reading to "warm up"?
+    sleep_for_milliseconds(5000); // give a bit of time for the GPS reading to "warm up"?; the receiver keeps tracking, the MCU sleeps
     wdt.restart();
 
-    // sample of few extra fixes for the n-sigma filtering; we sample at most enough to fill
-    // the accumulators, and we use at most 60 seconds
-    int crrt_fix_nbr {1};
-    unsigned long millis_start = millis();
-    while ( (crrt_fix_nbr < size_accumulators-1) && (millis() - millis_start < 60000UL)){
+    // sample a few extra fixes for the robust mean; we sample at most
+    // gnss_fix_maximum_number_of_fixes, we use at most 60 seconds, and we stop as soon as
+    // the mean is accurate enough
+    unsigned long millis_start = sleep_aware_millis();
+    while ( (estimator_latitude.count() < gnss_fix_maximum_number_of_fixes) &&
+            (sleep_aware_millis() - millis_start < 60000UL) &&
+            !fix_is_accurate_enough() ){
       if(get_a_fix(5UL, true, false, false)){
-        crrt_fix_nbr += 1;
-        crrt_accumulator_latitude.push_back(latitude);
-        crrt_accumulator_longitude.push_back(longitude);
-        crrt_accumulator_posix_timestamp.push_back(posix_timestamp);
+        push_fix_to_estimators();
         wdt.restart();
       }
     }
 
-    // we turn off by hand, since we did not perform full start stop in the loop
-    turn_gnss_off();
-    Wire1.end();
+    // we turn off by hand, since we did not perform full start stop in the loop; the
+    // receiver navigated, so its database is worth saving
+    power_down(true);
 
     // then, get the values for the filtered lat, lon, timestamp
-    long crrt_latitude = accurate_sigma_filter<long>(crrt_accumulator_latitude, 2.0);
-    long crrt_longitude = accurate_sigma_filter<long>(crrt_accumulator_longitude, 2.0); 
-    long crrt_posix_timestamp = accurate_sigma_filter<long>(crrt_accumulator_posix_timestamp, 2.0); 
+    long crrt_latitude = estimator_latitude.mean();
+    long crrt_longitude = estimator_longitude.mean();
+    long crrt_posix_timestamp = estimator_posix_timestamp.mean();
 
     fix_information crrt_fix {crrt_posix_timestamp, crrt_latitude, crrt_longitude};
 
-
-    SERIAL_USB->print(F("pushed fix: "));
-    SERIAL_USB->print(crrt_fix.posix_timestamp);
-    SERIAL_USB->print(F(" | "));
-    SERIAL_USB->print(crrt_fix.latitude);
-    SERIAL_USB->print(F(" | "));
-    SERIAL_USB->print(crrt_fix.longitude);
-    SERIAL_USB->println();
+    assistance_position = crrt_fix;
+    assistance_altitude = altitude;
+    assistance_position_valid = true;
+
+    if constexpr (LOG_ENABLED(info)){
+      SERIAL_USB->print(F("pushed fix: "));
+      SERIAL_USB->print(crrt_fix.posix_timestamp);
+      SERIAL_USB->print(F(" | "));
+      SERIAL_USB->print(crrt_fix.latitude);
+      SERIAL_USB->print(F(" | "));
+      SERIAL_USB->print(crrt_fix.longitude);
+      SERIAL_USB->print(F(" | fixes kept / rejected: "));
+      SERIAL_USB->print(estimator_latitude.count());
+      SERIAL_USB->print(F(" / "));
+      SERIAL_USB->print(estimator_latitude.rejected());
+      SERIAL_USB->println();
+    }
 
     return true;
   }
 
-  turn_gnss_off();
-  Wire1.end();
+  power_down(false);
   
   return false;
 }
 
+void GNSS_Manager::push_fix_to_estimators(void){
+  // reject the fix as a whole, so that lat, lon, and timestamp stay consistent
+  if (estimator_latitude.is_outlier(latitude) || estimator_longitude.is_outlier(longitude)){
+    estimator_latitude.reject(latitude);
+    estimator_longitude.reject(longitude);
+    LOG_PRINTLN(debug, F("GNSS fix rejected as outlier"));
+    return;
+  }
+
+  estimator_latitude.push(latitude);
+  estimator_longitude.push(longitude);
+  estimator_posix_timestamp.push(posix_timestamp);
+}
+
+bool GNSS_Manager::fix_is_accurate_enough(void) const {
+  return (gnss_fix_target_standard_error > 0) &&
+         (estimator_latitude.count() >= gnss_fix_minimum_number_of_fixes) &&
+         (estimator_latitude.standard_error() <= gnss_fix_target_standard_error) &&
+         (estimator_longitude.standard_error() <= gnss_fix_target_standard_error);
+}
+
+void GNSS_Manager::push_assistance(void){
+  // without the time, the receiver can use neither the position nor the database; the
+  // RTC may be valid without being right (main.cpp sets it to 0 before the first fix),
+  // so only trust it once set from a fix
+  if (!rtc_set_from_fix){
+    LOG_PRINTLN(debug, F("RTC not set from a GNSS fix yet, no GNSS assistance"));
+    return;
+  }
+
+  wdt.restart();
+
+  struct_YMDHMS const & crrt_time = YMDHMS_from_posix_timestamp(board_time_manager.get_posix_timestamp());
+  if (!gnss.setUTCTimeAssistance(crrt_time.year, crrt_time.month, crrt_time.day,
+                                 crrt_time.hour, crrt_time.minute, crrt_time.second,
+                                 0, gnss_assistance_time_accuracy_s)){
+    LOG_PRINTLN(warning, F("GNSS could not push time assistance"));
+    return;
+  }
+
+  if (assistance_position_valid){
+    // altitude in cm, accuracy in cm
+    if (!gnss.setPositionAssistanceLLH(assistance_position.latitude, assistance_position.longitude,
+                                       assistance_altitude / 10, 100UL * gnss_assistance_position_accuracy_m)){
+      LOG_PRINTLN(warning, F("GNSS could not push position assistance"));
+    }
+  }
+
+  wdt.restart();
+
+  size_t number_of_bytes_pushed {0};
+  if (navigation_database_size > 0){
+    number_of_bytes_pushed = gnss.pushAssistNowData(navigation_database, navigation_database_size);
+    if (number_of_bytes_pushed != navigation_database_size){
+      LOG_PRINTLN(warning, F("GNSS could not push the full navigation database"));
+    }
+  }
+
+  LOG_PRINT(debug, F("GNSS assistance pushed, database bytes: ")); LOG_PRINTLN(debug, number_of_bytes_pushed);
+  trace_log.record(Trace_Event::gnss_assistance, number_of_bytes_pushed);
+
+  wdt.restart();
+}
+
+void GNSS_Manager::save_navigation_database(void){
+  wdt.restart();
+
+  // the library allocates its MGA-DBD buffer on the heap at the first call
+  navigation_database_size = gnss.readNavigationDatabase(navigation_database, sizeof(navigation_database));
+
+  // when full, the dump was cut; a partial database is not worth pushing
+  if (navigation_database_size == sizeof(navigation_database)){
+    LOG_PRINTLN(warning, F("GNSS navigation database too large, dropped"));
+    navigation_database_size = 0;
+  }
+
+  LOG_PRINT(debug, F("GNSS navigation database bytes: ")); LOG_PRINTLN(debug, navigation_database_size);
+
+  wdt.restart();
+}
+
+void GNSS_Manager::power_down(bool save_database){
+  if constexpr (gnss_use_assistance){
+    if (save_database){
+      save_navigation_database();
+    }
+  }
+
+  turn_gnss_off();
+  Wire1.end();
+}
+
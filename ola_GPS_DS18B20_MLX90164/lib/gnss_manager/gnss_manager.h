@@ -1,7 +1,7 @@
 #ifndef GNSS_MANAGER
 #define GNSS_MANAGER
 
-#include "etl/vector.h"
+#include "log_utils.h"
 
 #include <Wire.h> // Needed for I2C
 #include <SparkFun_u-blox_GNSS_Arduino_Library.h> //http://librarymanager/All#SparkFun_u-blox_GNSS
@@ -10,6 +10,8 @@
 #include "watchdog_manager.h"
 
 #include "statistical_processing.h"
+#include "power_profiler.h"
+#include "trace_log.h"
 
 extern SFE_UBLOX_GNSS gnss;
 
@@ -48,12 +50,58 @@ class GNSS_Manager{
 
     unsigned int number_of_GPS_fixes {0};
     
-    static constexpr size_t size_accumulators {30};
-    etl::vector<long, size_accumulators> crrt_accumulator_latitude;
-    etl::vector<long, size_accumulators> crrt_accumulator_longitude;
-    etl::vector<long, size_accumulators> crrt_accumulator_posix_timestamp;
+    // the robust means of the fixes of the last get_and_push_fix; a fix is dropped if an
+    // outlier in lat or in lon (3 sigma, as the sigma is estimated from few fixes; the
+    // sigma being at least 20 1e-7 degrees, i.e. about 2 cm); the timestamp is the mean
+    // over the fixes kept
+    Streaming_Robust_Mean<long> estimator_latitude {3.0f, 20, gnss_fix_minimum_number_of_fixes};
+    Streaming_Robust_Mean<long> estimator_longitude {3.0f, 20, gnss_fix_minimum_number_of_fixes};
+    Streaming_Robust_Mean<long> estimator_posix_timestamp;
 
   private:
+    // wait until a 3D fix or the timeout, and return the last fix type; either polling
+    // the receiver every 500 ms, or reading the periodic NAV-PVT messages
+    byte wait_for_fix_polling(unsigned long timeout_seconds);
+    byte wait_for_fix_auto_pvt(unsigned long timeout_seconds);
+
+    // fill the fit data from the last navigation solution
+    void read_fix_polling(void);
+    void read_fix_auto_pvt(void);
+
+    // whether the receiver accepted the periodic NAV-PVT configuration at the last full start
+    bool auto_pvt_enabled {false};
+
+    // with the periodic NAV-PVT, deep sleep until a bit before the next epoch once a
+    // message is read, and then check for the next one at this interval
+    static constexpr unsigned long auto_pvt_wake_up_early_ms {50UL};
+    static constexpr unsigned long auto_pvt_check_interval_ms {20UL};
+    static_assert(gnss_navigation_epoch_ms > auto_pvt_wake_up_early_ms);
+
+    // add the current fix to the estimators, unless an outlier
+    void push_fix_to_estimators(void);
+    // whether the estimators reached gnss_fix_target_standard_error
+    bool fix_is_accurate_enough(void) const;
+
+    // hot start assistance, see gnss_use_assistance in user_configuration.h
+    // push the RTC time, the last position, and the saved navigation database; call once
+    // the receiver is configured
+    void push_assistance(void);
+    // whether the RTC was set from a GNSS fix, i.e. its time is worth pushing
+    bool rtc_set_from_fix {false};
+    // read the navigation database of the receiver; call before powering it off, only if
+    // it navigated, so that the database is fresh
+    void save_navigation_database(void);
+    // save the navigation database if asked, then power the receiver off
+    void power_down(bool save_database);
+
+    uint8_t navigation_database[gnss_use_assistance ? gnss_navigation_database_max_bytes : 1];
+    size_t navigation_database_size {0};
+
+    // the last position: of the last good fix of get_a_fix, or the filtered one of
+    // get_and_push_fix
+    bool assistance_position_valid {false};
+    fix_information assistance_position;
+    long assistance_altitude;  // mm
 };
 
 extern GNSS_Manager gnss_manager;
@@ -0,0 +1,64 @@
+#include "heap_guard.h"
+
+#include "log_utils.h"
+#include "trace_log.h"
+
+Heap_Guard heap_guard;
+
+void Heap_Guard::arm(void){
+    number_of_allocations = 0;
+    last_allocation_size = 0;
+    armed = true;
+}
+
+uint32_t Heap_Guard::disarm(void){
+    armed = false;
+
+    if (number_of_allocations > 0){
+        if constexpr (LOG_ENABLED(warning)){
+            SERIAL_USB->print(F("heap allocations in a guarded path: "));
+            SERIAL_USB->print(number_of_allocations);
+            SERIAL_USB->print(F(", last of size "));
+            SERIAL_USB->println(last_allocation_size);
+        }
+        trace_log.record(Trace_Event::heap_allocation, number_of_allocations);
+    }
+
+    return number_of_allocations;
+}
+
+void Heap_Guard::count_allocation(size_t size){
+    if constexpr (!heap_guard_enabled){
+        return;
+    }
+    if (armed){
+        number_of_allocations += 1;
+        last_allocation_size = size;
+    }
+}
+
+//--------------------------------------------------------------------------------
+// the allocator wrappers, see -Wl,--wrap in platformio.ini
+
+extern "C" {
+
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t number, size_t size);
+void * __real_realloc(void * pointer, size_t size);
+
+void * __wrap_malloc(size_t size){
+    heap_guard.count_allocation(size);
+    return __real_malloc(size);
+}
+
+void * __wrap_calloc(size_t number, size_t size){
+    heap_guard.count_allocation(number * size);
+    return __real_calloc(number, size);
+}
+
+void * __wrap_realloc(void * pointer, size_t size){
+    heap_guard.count_allocation(size);
+    return __real_realloc(pointer, size);
+}
+
+}
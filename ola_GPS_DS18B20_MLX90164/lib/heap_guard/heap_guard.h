@@ -0,0 +1,43 @@
+#ifndef HEAP_GUARD_H
+#define HEAP_GUARD_H
+
+#include "Arduino.h"
+
+#include "user_configuration.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// check that the acquisition paths do not use the heap
+//
+// the logger runs for months without a reboot, and otherwise only uses fixed capacity
+// containers (etl); a heap allocation in a path that runs at each wakeup (typically an
+// Arduino String) fragments the heap over time. malloc, calloc and realloc are wrapped at
+// link time (-Wl,--wrap=..., see platformio.ini): the wrappers count the allocations made
+// while the guard is armed, and hand them over to the real allocator. The code that arms
+// the guard checks the count when disarming it.
+//
+// the newlib internals that call _malloc_r directly are not seen; operator new, String,
+// strdup, etc, all go through malloc / realloc. The wrappers may be called from anywhere:
+// they only update the counters, and must not print or allocate.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class Heap_Guard{
+    public:
+        // start counting the allocations
+        void arm(void);
+
+        // stop counting; return the number of allocations since arm(), and report them
+        // (log warning, trace event heap_allocation) if any
+        uint32_t disarm(void);
+
+        // called by the allocator wrappers
+        void count_allocation(size_t size);
+
+    private:
+        bool armed {false};
+        uint32_t number_of_allocations {0};
+        size_t last_allocation_size {0};
+};
+
+extern Heap_Guard heap_guard;
+
+#endif
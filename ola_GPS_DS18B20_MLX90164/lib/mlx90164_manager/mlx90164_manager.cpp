@@ -1,44 +1,121 @@
 #include "mlx90164_manager.h"
 
+// the acquisition runs at each wakeup for months: no heap, see heap_guard.h
+#pragma GCC poison String
+
 IRTherm therm; // Create an IRTherm object to interact with throughout
 TwoWireArtemis WireArtemis;
+MLXIOMTransport mlx_iom_transport;
+
+// the factory default of the Config Register 1: IIR bypassed, FIR N = 1024, single IR sensor
+static constexpr uint16_t mlx_factory_config_register {0x9FB4};
+
+// the number of measurement cycles for the IIR filter to forget the previous measurements,
+// to 1%, by IIR setting (Config Register 1 bits [2:0]); the filter weighs the new
+// measurement by a1 = 0.5 (000), 0.25 (001), 0.167 (010), 0.125 (011), 1 (100, bypassed),
+// 0.8 (101), 0.667 (110), 0.571 (111), i.e. the previous ones by (1 - a1)^cycles
+static constexpr unsigned long mlx_iir_settle_cycles[8] {7, 17, 26, 35, 1, 3, 5, 6};
 
 void turn_mlx_on(void){
     pinMode(PIN_QWIIC_PWR, OUTPUT);
     digitalWrite(PIN_QWIIC_PWR, HIGH);
-    delay(1000);
+    power_profiler.peripheral_on(Power_Peripheral::qwiic);
+    if constexpr (mlx_paced_readings){
+        sleep_for_milliseconds(mlx_power_up_ms);
+    }
+    else{
+        delay(1000);
+    }
     wdt.restart();
 }
 
 void turn_mlx_off(void){
+    // release the IOM for Wire1, and the pads, before the sensor loses power
+    if constexpr (mlx_use_hardware_i2c){
+        mlx_iom_transport.end();
+    }
     pinMode(PIN_QWIIC_PWR, OUTPUT);
     digitalWrite(PIN_QWIIC_PWR, LOW);
+    power_profiler.peripheral_off(Power_Peripheral::qwiic);
+}
+
+bool MLX90164_Manager::start_sensor(int attempt){
+    if constexpr (mlx_use_hardware_i2c){
+        if (mlx_iom_transport.begin() && therm.begin(MLX90614_DEFAULT_ADDRESS, mlx_iom_transport)){
+            return true;
+        }
+        LOG_PRINTLN(warning, F("Qwiic IR thermometer not answering on the hardware I2C; try SoftWire"));
+        trace_log.record(Trace_Event::mlx_hardware_i2c_fallback, attempt);
+        mlx_iom_transport.end();
+    }
+
+    WireArtemis.begin();
+    return therm.begin();
+}
+
+void MLX90164_Manager::set_pacing(uint16_t config_register){
+    // FIR N = 8 << bits [10:8]
+    unsigned long const fir_length = 8UL << ((config_register >> 8) & 0x07);
+    // bit 6: 2 IR sensors, measured one after the other
+    unsigned long const number_of_ir_sensors = (config_register & 0x40) ? 2 : 1;
+
+    measurement_cycle_ms = mlx_measurement_period_fir_1024_ms * fir_length * number_of_ir_sensors / 1024UL;
+    if (measurement_cycle_ms == 0){
+        measurement_cycle_ms = 1;
+    }
+    settle_cycles = mlx_iir_settle_cycles[config_register & 0x07];
+
+    if constexpr (LOG_ENABLED(info)){
+        SERIAL_USB->print(F("MLX config 0x")); SERIAL_USB->print(config_register, HEX);
+        SERIAL_USB->print(F(", measurement cycle ms ")); SERIAL_USB->print(measurement_cycle_ms);
+        SERIAL_USB->print(F(", settle cycles ")); SERIAL_USB->println(settle_cycles);
+    }
 }
 
 void MLX90164_Manager::push_1_measurement(void){
-    delay(1000);
-    if (therm.read()) // On success, read() will return 1, on fail 0.
+    if constexpr (mlx_paced_readings){
+        sleep_for_milliseconds(measurement_cycle_ms * settle_cycles);
+    }
+    else{
+        delay(1000);
+    }
+    // Ta and Tobj1 back to back, PEC checked; Tobj2 is not logged, so not read
+    IRThermRaw raw;
+    if (therm.readRaw(&raw)) // On success, readRaw() will return 1, on fail 0.
     {
-        // Use the object() and ambient() functions to grab the object and ambient
-        // temperatures.
-        // They'll be floats, calculated out to the unit you set with setUnit().
-        SERIAL_USB->print("Object: " + String(therm.object(), 2));
-        SERIAL_USB->println(F("C"));
-        SERIAL_USB->print("Ambient: " + String(therm.ambient(), 2));
-        SERIAL_USB->println(F("C"));
+        if constexpr (LOG_ENABLED(debug)){
+            SERIAL_USB->print(F("Object: "));
+            print_fiftieths_kelvin_as_celsius_to_serial_print_buff(raw.object1);
+            SERIAL_USB->print(serial_print_buff);
+            SERIAL_USB->println(F("C"));
+            SERIAL_USB->print(F("Ambient: "));
+            print_fiftieths_kelvin_as_celsius_to_serial_print_buff(raw.ambient);
+            SERIAL_USB->print(serial_print_buff);
+            SERIAL_USB->println(F("C"));
+        }
 
         MLX_Information mlx_information{
             board_time_manager.get_posix_timestamp(),
-            therm.object(),
-            therm.ambient()
+            IRTherm::rawToCelsius(raw.object1),
+            IRTherm::rawToCelsius(raw.ambient)
         };
 
         crrt_accumulator_MLX.push_back(mlx_information);
     }
+    else {
+        trace_log.record(Trace_Event::mlx_read_failed);
+    }
     wdt.restart();
 }
 
 bool MLX90164_Manager::acquire_n_readings(size_t nbr_readings){
+    heap_guard.arm();
+    bool const success = run_acquisition(nbr_readings);
+    heap_guard.disarm();
+    return success;
+}
+
+bool MLX90164_Manager::run_acquisition(size_t nbr_readings){
     turn_mlx_on();
     wdt.restart();
 
@@ -46,14 +123,19 @@ bool MLX90164_Manager::acquire_n_readings(size_t nbr_readings){
     // start the sensor
 
     // give time for the sensor to wake up
-    delay(500);
-    WireArtemis.begin();
-    wdt.restart();
-
+    if constexpr (!mlx_paced_readings){
+        delay(500);
+    }
     for (int i=0; i<5; i++){
-        if (therm.begin() == false){ // Initialize the MLX90614
-            SERIAL_USB->println(F("Qwiic IR thermometer did not start; aborting"));
-            delay(1000);
+        if (start_sensor(i) == false){ // Initialize the MLX90614
+            LOG_PRINTLN(warning, F("Qwiic IR thermometer did not start; aborting"));
+            trace_log.record(Trace_Event::mlx_start_failed, i);
+            if constexpr (mlx_paced_readings){
+                sleep_for_milliseconds(mlx_power_up_ms);
+            }
+            else{
+                delay(1000);
+            }
 
             if (i==4){
                 turn_mlx_off();
@@ -64,21 +146,35 @@ bool MLX90164_Manager::acquire_n_readings(size_t nbr_readings){
             break;
         }
     }
-    SERIAL_USB->println(F("Qwiic IR thermometer started"));
+    LOG_PRINTLN(info, F("Qwiic IR thermometer started"));
     wdt.restart();
 
-    if (therm.readID()){
-        SERIAL_USB->println("ID: 0x" + 
-                    String(therm.getIDH(), HEX) +
-                    String(therm.getIDL(), HEX));
+    // these reads are only for the serial output
+    if constexpr (LOG_ENABLED(debug)){
+        if (therm.readID()){
+            snprintf(serial_print_buff, serial_print_max_buffer, "ID: 0x%08lX%08lX",
+                     static_cast<unsigned long>(therm.getIDH()),
+                     static_cast<unsigned long>(therm.getIDL()));
+            SERIAL_USB->println(serial_print_buff);
+        }
+        SERIAL_USB->print(F("Emissivity: "));
+        SERIAL_USB->println(therm.readEmissivity());
     }
-    SERIAL_USB->println(String(therm.readEmissivity()));
     wdt.restart();
 
     therm.setUnit(TEMP_C);
     crrt_accumulator_MLX.clear();
     wdt.restart();
 
+    if constexpr (mlx_paced_readings){
+        uint16_t config_register {mlx_factory_config_register};
+        if (!therm.readConfig(&config_register)){
+            LOG_PRINTLN(warning, F("could not read the MLX config; assume the factory one"));
+            config_register = mlx_factory_config_register;
+        }
+        set_pacing(config_register);
+    }
+
     // buoy started
     // ------------------------------------------------------
 
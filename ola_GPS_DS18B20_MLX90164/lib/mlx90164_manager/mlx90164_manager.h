@@ -3,12 +3,20 @@
 
 #include "etl/vector.h"
 
+#include "log_utils.h"
+#include "print_utils.h"
+
 #include "time_manager.h"
+#include "sleep_manager.h"
 #include "watchdog_manager.h"
+#include "power_profiler.h"
+#include "trace_log.h"
+#include "heap_guard.h"
 
 #include <defWireArtemis.h>
 #include <SparkFunMLX90614.h>//Click here to get the library: http://librarymanager/All#Qwiic_IR_Thermometer by SparkFun
 #include <SoftWireArtemis/MLX_SoftWireArtemis.h>
+#include <MLXTransport.h>
 
 // NOTE: the default I2C pins, that may change from board to board, are set at:
 // defWireArtemis.h
@@ -27,7 +35,19 @@ class MLX90164_Manager{
         etl::vector<MLX_Information, size_buffer> crrt_accumulator_MLX;
 
     private:
+        // the acquisition itself; acquire_n_readings runs it under the heap guard
+        bool run_acquisition(size_t nbr_readings);
+
         void push_1_measurement(void);
+
+        // start the MLX on the hardware I2C if mlx_use_hardware_i2c, and on SoftWire
+        // if not or if that fails; see MLXTransport.h
+        bool start_sensor(int attempt);
+
+        // the pacing of the readings, see mlx_paced_readings in user_configuration.h
+        void set_pacing(uint16_t config_register);
+        unsigned long measurement_cycle_ms {mlx_measurement_period_fir_1024_ms};
+        unsigned long settle_cycles {1};
 };
 
 extern MLX90164_Manager mlx90164_manager;
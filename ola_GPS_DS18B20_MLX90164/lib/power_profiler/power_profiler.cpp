@@ -0,0 +1,154 @@
+#include "power_profiler.h"
+
+Power_Profiler power_profiler;
+
+// keep in sync with the order of the statistics, and with tools/decode_binary_data.py
+static char const * const power_statistics_names[Power_Profiler::number_of_statistics] {
+    "blink",
+    "gnss",
+    "thermistors",
+    "mlx",
+    "sd_logging",
+    "qwiic_on",
+    "ds18b20_on",
+    "sd_on",
+    "awake",
+    "cycle_s",
+    "sd_busy",
+};
+
+//--------------------------------------------------------------------------------
+// running statistics
+
+void Power_Running_Statistics::push(uint32_t value){
+    last = value;
+    count += 1;
+    sum += value;
+    if (value > max){
+        max = value;
+    }
+}
+
+uint32_t Power_Running_Statistics::mean(void) const {
+    if (count == 0){
+        return 0;
+    }
+    return static_cast<uint32_t>(sum / count);
+}
+
+//--------------------------------------------------------------------------------
+// profiler
+
+char const * Power_Profiler::get_statistics_name(size_t index){
+    if (index >= number_of_statistics){
+        return "unknown";
+    }
+    return power_statistics_names[index];
+}
+
+void Power_Profiler::start_wakeup(void){
+    wakeup_start_us = micros();
+    unsigned long const peripherals_start_us = sleep_aware_micros();
+
+    for (size_t ind=0; ind<number_of_phases; ind++){
+        phase_duration_us[ind] = 0;
+        phase_running[ind] = false;
+        phase_ran[ind] = false;
+    }
+
+    for (size_t ind=0; ind<number_of_peripherals; ind++){
+        peripheral_on_duration_us[ind] = 0;
+        // a peripheral left on during sleep is accounted from the start of the wakeup
+        peripheral_on_since_us[ind] = peripherals_start_us;
+    }
+
+    sd_busy_duration_us = 0;
+
+    // the cycle duration only makes sense if the RTC was not set to a new time in between
+    kiss_time_t const crrt_posix = board_time_manager.get_posix_timestamp();
+    if (last_wakeup_posix_valid && (crrt_posix >= last_wakeup_posix) &&
+        (crrt_posix - last_wakeup_posix <= static_cast<kiss_time_t>(max_sleep_seconds + 3600UL))){
+        statistics[index_cycle].push(static_cast<uint32_t>(crrt_posix - last_wakeup_posix));
+    }
+    last_wakeup_posix = crrt_posix;
+    last_wakeup_posix_valid = true;
+}
+
+void Power_Profiler::end_wakeup(void){
+    unsigned long const crrt_us = micros();
+    unsigned long const peripherals_crrt_us = sleep_aware_micros();
+
+    for (size_t ind=0; ind<number_of_phases; ind++){
+        if (phase_running[ind]){
+            stop_phase(static_cast<Power_Phase>(ind));
+        }
+        if (phase_ran[ind]){
+            statistics[ind].push(phase_duration_us[ind]);
+        }
+    }
+
+    for (size_t ind=0; ind<number_of_peripherals; ind++){
+        uint32_t on_duration_us = peripheral_on_duration_us[ind];
+        if (peripheral_is_on[ind]){
+            on_duration_us += peripherals_crrt_us - peripheral_on_since_us[ind];
+        }
+        statistics[index_first_peripheral + ind].push(on_duration_us);
+    }
+
+    statistics[index_awake].push(crrt_us - wakeup_start_us);
+    statistics[index_sd_busy].push(sd_busy_duration_us);
+
+    if constexpr (LOG_ENABLED(info)){
+        print_status();
+    }
+}
+
+void Power_Profiler::start_phase(Power_Phase phase){
+    size_t const ind = static_cast<size_t>(phase);
+    phase_start_us[ind] = micros();
+    phase_running[ind] = true;
+}
+
+void Power_Profiler::stop_phase(Power_Phase phase){
+    size_t const ind = static_cast<size_t>(phase);
+    if (!phase_running[ind]){
+        return;
+    }
+    phase_duration_us[ind] += micros() - phase_start_us[ind];
+    phase_running[ind] = false;
+    phase_ran[ind] = true;
+}
+
+void Power_Profiler::peripheral_on(Power_Peripheral peripheral){
+    size_t const ind = static_cast<size_t>(peripheral);
+    if (peripheral_is_on[ind]){
+        return;
+    }
+    peripheral_on_since_us[ind] = sleep_aware_micros();
+    peripheral_is_on[ind] = true;
+}
+
+void Power_Profiler::peripheral_off(Power_Peripheral peripheral){
+    size_t const ind = static_cast<size_t>(peripheral);
+    if (!peripheral_is_on[ind]){
+        return;
+    }
+    peripheral_on_duration_us[ind] += sleep_aware_micros() - peripheral_on_since_us[ind];
+    peripheral_is_on[ind] = false;
+}
+
+void Power_Profiler::print_status(void) const {
+    SERIAL_USB->println(F("- Power_Profiler: name, last, count, mean, max (us; s for cycle_s) -"));
+    for (size_t ind=0; ind<number_of_statistics; ind++){
+        SERIAL_USB->print(get_statistics_name(ind));
+        SERIAL_USB->print(F(", "));
+        SERIAL_USB->print(statistics[ind].last);
+        SERIAL_USB->print(F(", "));
+        SERIAL_USB->print(statistics[ind].count);
+        SERIAL_USB->print(F(", "));
+        SERIAL_USB->print(statistics[ind].mean());
+        SERIAL_USB->print(F(", "));
+        SERIAL_USB->println(statistics[ind].max);
+    }
+    SERIAL_USB->println(F("---------------"));
+}
@@ -0,0 +1,119 @@
+#ifndef POWER_PROFILER_H
+#define POWER_PROFILER_H
+
+#include "Arduino.h"
+
+#include "firmware_configuration.h"
+#include "user_configuration.h"
+#include "print_utils.h"
+#include "log_utils.h"
+
+#include "time_manager.h"
+#include "sleep_manager.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// record how long each phase of a wakeup keeps the MCU awake, and how long each peripheral
+// is powered, to see what dominates the battery budget
+//
+// the phase and awake durations are measured with micros(), that does not advance during
+// the short deep sleeps of sleep_for_milliseconds: these are the time actually spent awake.
+// the peripheral on durations are measured with sleep_aware_micros(), as the peripherals
+// stay powered during the short sleeps. The duration of the full wakeup to wakeup cycle,
+// that includes the long sleep, is measured with the RTC posix_timestamp.
+// running statistics since boot are kept in RAM (retained during sleep), and appended to
+// each data record.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// the phases of a wakeup; a phase may run several times in a wakeup (e.g. the LED blink
+// sequences), the durations are then summed for the wakeup
+enum class Power_Phase : uint8_t {
+    blink = 0,
+    gnss,
+    thermistors,
+    mlx,
+    sd_logging,
+    number_of_phases
+};
+
+// the switchable peripherals; the SD card is not power switched on the logger, so its
+// "on" duration is the duration it is in use (started to stopped)
+enum class Power_Peripheral : uint8_t {
+    qwiic = 0,
+    ds18b20,
+    sd,
+    number_of_peripherals
+};
+
+// running statistics of a duration, since boot
+struct Power_Running_Statistics {
+    uint32_t last {0};
+    uint32_t count {0};
+    uint64_t sum {0};
+    uint32_t max {0};
+
+    void push(uint32_t value);
+    uint32_t mean(void) const;
+};
+
+class Power_Profiler{
+    public:
+        static constexpr size_t number_of_phases {static_cast<size_t>(Power_Phase::number_of_phases)};
+        static constexpr size_t number_of_peripherals {static_cast<size_t>(Power_Peripheral::number_of_peripherals)};
+
+        // all the statistics, in this order: the phases, the peripherals, the full awake
+        // duration (all in us), the wakeup to wakeup cycle duration (in s), and the time
+        // spent waiting for the SD card to not be busy (in us)
+        static constexpr size_t index_first_peripheral {number_of_phases};
+        static constexpr size_t index_awake {number_of_phases + number_of_peripherals};
+        static constexpr size_t index_cycle {index_awake + 1};
+        static constexpr size_t index_sd_busy {index_cycle + 1};
+        static constexpr size_t number_of_statistics {index_sd_busy + 1};
+
+        // call when waking up, and just before going to sleep; the statistics are updated
+        // at the end of each wakeup, i.e. a record written during a wakeup holds the phases
+        // that ran in previous wakeups
+        void start_wakeup(void);
+        void end_wakeup(void);
+
+        void start_phase(Power_Phase phase);
+        void stop_phase(Power_Phase phase);
+
+        // call when switching the power of a peripheral; switching on a peripheral that is
+        // already on, or off one that is already off, is fine
+        void peripheral_on(Power_Peripheral peripheral);
+        void peripheral_off(Power_Peripheral peripheral);
+
+        // call with each busy wait of the SD card; summed over the wakeup
+        void add_sd_busy(uint32_t duration_us){ sd_busy_duration_us += duration_us; }
+
+        Power_Running_Statistics const & get_statistics(size_t index) const { return statistics[index]; }
+
+        // a short name for each statistics, used in the ASCII log; the host side decoder
+        // uses the same names
+        static char const * get_statistics_name(size_t index);
+
+        void print_status(void) const;
+
+    private:
+        Power_Running_Statistics statistics[number_of_statistics];
+
+        unsigned long wakeup_start_us {0};
+
+        unsigned long phase_start_us[number_of_phases] {};
+        uint32_t phase_duration_us[number_of_phases] {};
+        bool phase_running[number_of_phases] {};
+        bool phase_ran[number_of_phases] {};
+
+        unsigned long peripheral_on_since_us[number_of_peripherals] {};
+        uint32_t peripheral_on_duration_us[number_of_peripherals] {};
+        bool peripheral_is_on[number_of_peripherals] {};
+
+        uint32_t sd_busy_duration_us {0};
+
+        kiss_time_t last_wakeup_posix {0};
+        bool last_wakeup_posix_valid {false};
+};
+
+extern Power_Profiler power_profiler;
+
+#endif
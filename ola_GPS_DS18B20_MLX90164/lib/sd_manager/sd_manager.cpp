@@ -2,18 +2,37 @@
 
 SD_Manager sd_manager_instance;
 
+// the largest blocks, from the capacities of the containers they are written from; the
+// boot block of the preallocated modes goes with the first data block, in the same file
+static constexpr uint32_t largest_data_block_length =
+    sizeof(Binary_Block_Header)
+    + sizeof(Binary_Section_Header) + decltype(board_thermistors_manager.vector_of_readings)::MAX_SIZE * sizeof(Binary_Thermistor_Record)
+    + sizeof(Binary_Section_Header) + decltype(board_thermistors_manager.vector_of_statistics)::MAX_SIZE * sizeof(Binary_Thermistor_Statistics_Record)
+    + sizeof(Binary_Section_Header) + MLX90164_Manager::size_buffer * sizeof(Binary_MLX_Record)
+    + (sd_log_power_profile ? sizeof(Binary_Section_Header) + Power_Profiler::number_of_statistics * sizeof(Binary_Power_Profile_Record) : 0)
+    + binary_block_crc_size;
+static constexpr uint32_t largest_boot_block_length =
+    sizeof(Binary_Block_Header)
+    + sizeof(Binary_Section_Header) + trace_log_number_of_records * sizeof(Binary_Trace_Record)
+    + binary_block_crc_size;
+static_assert(SD_Manager::padded_block_length(largest_boot_block_length) + SD_Manager::padded_block_length(largest_data_block_length)
+                  <= sd_preallocated_file_size_bytes,
+              "sd_preallocated_file_size_bytes cannot hold the largest boot and data blocks");
+
 // for doing manipulations on strings
 static constexpr size_t work_buffer_size{32};
 char work_buffer[work_buffer_size];
 
-void SD_Manager::start()
+void SD_Manager::start_card()
 {
     // start the SD card
+    power_profiler.peripheral_on(Power_Peripheral::sd);
     SdSpiConfig sd_config{SD_CS_PIN, DEDICATED_SPI, SD_SCK_MHZ(SD_SPI_MHZ)};
 
     while (!sd_card.begin(sd_config))
     {
-        SERIAL_USB->println(F("ERR Cannot start SD card"));
+        LOG_PRINTLN(error, F("ERR Cannot start SD card"));
+        trace_log.record(Trace_Event::sd_start_failed);
 
         // watchdog reboot
         while (true)
@@ -21,46 +40,222 @@ void SD_Manager::start()
         }
     }
 
-    delay(100);
+    wait_while_card_busy();
+}
+
+void SD_Manager::wait_while_card_busy()
+{
+    unsigned long const micros_start = micros();
+
+    while (sd_card.card()->isBusy())
+    {
+        wdt.restart();
+
+        if (micros() - micros_start > sd_busy_timeout_us)
+        {
+            LOG_PRINTLN(warning, F("W SD card busy timeout"));
+            trace_log.record(Trace_Event::sd_busy_timeout);
+            break;
+        }
+    }
+
     wdt.restart();
+    power_profiler.add_sd_busy(micros() - micros_start);
+}
+
+void SD_Manager::start()
+{
+    start_card();
 
     // open the file using the filename that is already set
-    if (!sd_file.open(sd_filename, O_RDWR | O_CREAT))
+    // in binary mode, go to the end of the file, so that if the file already contains a
+    // block, the new one is appended after it; since all blocks are zero padded to a
+    // sector boundary, the end of the file is sector aligned
+    oflag_t open_flags {O_RDWR | O_CREAT};
+    if constexpr (sd_log_data_binary)
+    {
+        open_flags |= O_AT_END;
+    }
+
+    if (!sd_file.open(sd_filename, open_flags))
     {
-        Serial.println(F("ERR cannot open file"));
+        LOG_PRINTLN(error, F("ERR cannot open file"));
 
         while (true)
         {
         };
     }
 
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
 
     // at this point, ready to write etc to file
 }
 
+void SD_Manager::start_binary(uint32_t block_length)
+{
+    if constexpr (sd_file_mode == SD_File_Mode::one_file_per_wakeup)
+    {
+        start();
+        return;
+    }
+
+    uint32_t const padded_length = padded_block_length(block_length);
+
+    // would never fit, even in a new file: rolling over would loop until the watchdog reboot
+    if (padded_length > sd_preallocated_file_size_bytes)
+    {
+        LOG_PRINTLN(warning, F("block larger than a preallocated file, write it to its own file"));
+        trace_log.record(Trace_Event::sd_block_too_large, padded_length);
+
+        // the block is not written to the preallocated file; find its offset again next time
+        append_offset_valid = false;
+        update_filename_per_wakeup();
+        start();
+        return;
+    }
+
+    start_card();
+
+    while (true)
+    {
+        open_preallocated_file();
+
+        // compare to the preallocated size rather than to fileSize(): on exFAT cards,
+        // fileSize() only covers the part of a preallocated file that was written
+        if (append_offset + padded_length <= sd_preallocated_file_size_bytes)
+        {
+            break;
+        }
+
+        // the current file is full; roll over to the next one
+        LOG_PRINTLN(info, F("preallocated file full, roll over"));
+        sd_file.close();
+        file_rollover_index += 1;
+        update_filename();
+    }
+
+    if (!sd_file.seekSet(append_offset))
+    {
+        LOG_PRINTLN(error, F("ERR cannot seek in file"));
+
+        while (true)
+        {
+        };
+    }
+
+    // at this point, ready to write the block to file
+}
+
+void SD_Manager::open_preallocated_file()
+{
+    // a different file than the one we tracked so far: need to find the offset again
+    if (strncmp(sd_filename, preallocated_filename, sizeof(sd_filename)) != 0)
+    {
+        append_offset_valid = false;
+        strncpy(preallocated_filename, sd_filename, sizeof(preallocated_filename));
+    }
+
+    if (!sd_card.exists(sd_filename))
+    {
+        if (!sd_file.open(sd_filename, O_RDWR | O_CREAT))
+        {
+            LOG_PRINTLN(error, F("ERR cannot create file"));
+
+            while (true)
+            {
+            };
+        }
+
+        LOG_PRINT(info, F("preallocate new file "));
+        LOG_PRINTLN(info, sd_filename);
+
+        // one contiguous chunk, so that the FAT is updated once, here, and never again
+        if (!sd_file.preAllocate(sd_preallocated_file_size_bytes))
+        {
+            LOG_PRINTLN(error, F("ERR cannot preallocate file"));
+
+            while (true)
+            {
+            };
+        }
+        wdt.restart();
+
+        append_offset = 0;
+        append_offset_valid = true;
+        return;
+    }
+
+    if (!sd_file.open(sd_filename, O_RDWR))
+    {
+        LOG_PRINTLN(error, F("ERR cannot open file"));
+
+        while (true)
+        {
+        };
+    }
+
+    if (!append_offset_valid)
+    {
+        append_offset = find_append_offset();
+        append_offset_valid = true;
+    }
+}
+
+uint32_t SD_Manager::find_append_offset()
+{
+    uint16_t const boot_number = boot_counter_instance.get_boot_number();
+
+    uint32_t crrt_offset {0};
+    Binary_Block_Header header;
+
+    // the preallocated part of the file is not erased, so only trust blocks that were
+    // written during this boot
+    while (crrt_offset + sizeof(Binary_Block_Header) <= sd_file.fileSize())
+    {
+        wdt.restart();
+
+        if (!sd_file.seekSet(crrt_offset))
+        {
+            break;
+        }
+        if (sd_file.read(&header, sizeof(Binary_Block_Header)) != sizeof(Binary_Block_Header))
+        {
+            break;
+        }
+        if ((header.magic != binary_block_magic) || (header.boot_number != boot_number) || (header.block_length == 0))
+        {
+            break;
+        }
+
+        crrt_offset += (header.block_length + sd_sector_size - 1) / sd_sector_size * sd_sector_size;
+    }
+
+    LOG_PRINT(debug, F("found append offset: "));
+    LOG_PRINTLN(debug, crrt_offset);
+
+    return crrt_offset;
+}
+
 void SD_Manager::stop()
 {
     // flush to the SD card to make sure all is written
     sd_file.flush();
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
 
     // close the file
     if (!sd_file.close())
     {
-        SERIAL_USB->println(F("ERR cannot close file"));
+        LOG_PRINTLN(error, F("ERR cannot close file"));
+        trace_log.record(Trace_Event::sd_write_error, 1);
         while (true)
         {
         };
     }
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
 
     // stop the SD card, stop SPI etc so that ready to sleep, restart, etc
     sd_card.end();
-    delay(100);
+    power_profiler.peripheral_off(Power_Peripheral::sd);
     wdt.restart();
 }
 
@@ -71,6 +266,49 @@ void SD_Manager::update_filename()
 
     uint16_t boot_number = boot_counter_instance.get_boot_number();
 
+    if constexpr (sd_file_mode == SD_File_Mode::one_file_per_day)
+    {
+        // a new day starts with a new file
+        uint32_t crrt_day = board_time_manager.get_posix_timestamp() / 86400UL;
+        if (crrt_day != file_rollover_day)
+        {
+            file_rollover_day = crrt_day;
+            file_rollover_index = 0;
+        }
+
+        // BBBBB-YYYY-MM-DD-NN.bin
+        snprintf(sd_filename, sizeof(sd_filename), "%05u-%04u-%02u-%02u-%02u.bin",
+                 static_cast<unsigned int>(boot_number),
+                 static_cast<unsigned int>(crrt_calendar_time.year),
+                 static_cast<unsigned int>(crrt_calendar_time.month),
+                 static_cast<unsigned int>(crrt_calendar_time.day),
+                 static_cast<unsigned int>(file_rollover_index));
+
+        LOG_PRINTLN(debug, sd_filename);
+        return;
+    }
+
+    if constexpr (sd_file_mode == SD_File_Mode::one_file_per_boot)
+    {
+        // BBBBB-NN.bin
+        snprintf(sd_filename, sizeof(sd_filename), "%05u-%02u.bin",
+                 static_cast<unsigned int>(boot_number),
+                 static_cast<unsigned int>(file_rollover_index));
+
+        LOG_PRINTLN(debug, sd_filename);
+        return;
+    }
+
+    update_filename_per_wakeup();
+}
+
+void SD_Manager::update_filename_per_wakeup()
+{
+    kiss_calendar_time crrt_calendar_time;
+    posix_to_calendar(board_time_manager.get_posix_timestamp(), &crrt_calendar_time);
+
+    uint16_t boot_number = boot_counter_instance.get_boot_number();
+
     // BBBBB- (6 chars)
     snprintf(&(sd_filename[0]), 5 + 1, "%05u", boot_number);
     sd_filename[5] = '-';
@@ -92,54 +330,93 @@ void SD_Manager::update_filename()
     // SS. (3 chars)
     snprintf(&(sd_filename[23]), 2 + 1, "%02u", crrt_calendar_time.second);
     sd_filename[25] = '.';
-    // .dat
-    sd_filename[26] = 'd';
-    sd_filename[27] = 'a';
-    sd_filename[28] = 't';
+    // .dat for ASCII, .bin for binary blocks
+    if constexpr (sd_log_data_binary){
+        sd_filename[26] = 'b';
+        sd_filename[27] = 'i';
+        sd_filename[28] = 'n';
+    }
+    else {
+        sd_filename[26] = 'd';
+        sd_filename[27] = 'a';
+        sd_filename[28] = 't';
+    }
     sd_filename[29] = '\0';
 
-    SERIAL_USB->println(sd_filename);
+    LOG_PRINTLN(debug, sd_filename);
 }
 
 void SD_Manager::log_boot(void)
 {
+    if constexpr (sd_log_data_binary){
+        log_boot_binary();
+        return;
+    }
+
     start();
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
 
     sd_file.print(F("\n\nBOOT\n\n"));
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
+
+    // writing may itself record events; only write the ones recorded so far
+    uint32_t const number_of_trace_records = trace_log.size();
+
+    sd_file.print(F("TRACE_START\n"));
+    sd_file.println(F("RECORD_NBR,BOOT_NUMBER,POSIX_TIMESTAMP,EVENT,ARG,"));
+    for (uint32_t i=0; i<number_of_trace_records; i++){
+        Trace_Record const & crrt_record = trace_log.get_record(i);
+        sd_file.print(i);
+        sd_file.print(",");
+        sd_file.print(crrt_record.boot_number);
+        sd_file.print(",");
+        sd_file.print(crrt_record.posix_timestamp);
+        sd_file.print(",");
+        sd_file.print(Trace_Log::get_event_name(crrt_record.event));
+        sd_file.print(",");
+        sd_file.print(crrt_record.arg);
+        sd_file.println(",");
+        wdt.restart();
+    }
+    sd_file.print(F("TRACE_STOP\n\n"));
+    wait_while_card_busy();
+
     sd_file.print(F("BOOT_done\n\n"));
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
 
     stop();
-    delay(100);
-    wdt.restart();
+
+    // stop() reboots if the file cannot be closed, so the trace is on the card
+    trace_log.clear();
 }
 
 void SD_Manager::log_data(void)
 {
-    SERIAL_USB->println(F("start log_data..."));
+    if constexpr (sd_log_data_binary){
+        log_data_binary();
+    }
+    else {
+        log_data_ascii();
+    }
+}
+
+void SD_Manager::log_data_ascii(void)
+{
+    LOG_PRINTLN(info, F("start log_data..."));
 
     start();
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
 
     sd_file.print(F("\n\nDATA-start\n\n"));
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
 
     sd_file.print(F("THERMISTORS_START\n"));
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
 
     sd_file.print(F("THERMISTORS_POSIX_TIME_START: "));
     print_uint64_to_serial_print_buff(board_thermistors_manager.posix_time_start);
     sd_file.println(serial_print_buff);
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
 
     sd_file.println(F("READING_NBR,THERMISTOR_ID,CELCIUS,"));
 
@@ -151,20 +428,45 @@ void SD_Manager::log_data(void)
         print_uint64_to_serial_print_buff(crrt_reading.id);
         sd_file.print(serial_print_buff);
         sd_file.print(",");
-        sd_file.print(crrt_reading.reading);
+        print_sixteenths_to_serial_print_buff(crrt_reading.raw);
+        sd_file.print(serial_print_buff);
         sd_file.println(",");
-        delay(10);
         wdt.restart();
     }
 
     sd_file.print(F("THERMISTORS_STOP\n\n"));
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
+
+    sd_file.print(F("THERMISTORS_STATISTICS_START\n"));
+    sd_file.println(F("THERMISTOR_ID,COUNT,MEAN_CELCIUS,STD_CELCIUS,MIN_CELCIUS,MAX_CELCIUS,CRC_FAILURES,"));
+
+    for (ThermistorStatistics const & crrt_statistics : board_thermistors_manager.vector_of_statistics){
+        print_uint64_to_serial_print_buff(crrt_statistics.id);
+        sd_file.print(serial_print_buff);
+        sd_file.print(",");
+        sd_file.print(crrt_statistics.count);
+        sd_file.print(",");
+        sd_file.print(crrt_statistics.mean_celsius(), 4);
+        sd_file.print(",");
+        sd_file.print(crrt_statistics.std_celsius(), 4);
+        sd_file.print(",");
+        print_sixteenths_to_serial_print_buff(crrt_statistics.min_raw);
+        sd_file.print(serial_print_buff);
+        sd_file.print(",");
+        print_sixteenths_to_serial_print_buff(crrt_statistics.max_raw);
+        sd_file.print(serial_print_buff);
+        sd_file.print(",");
+        sd_file.print(crrt_statistics.crc_failures);
+        sd_file.println(",");
+        wdt.restart();
+    }
+
+    sd_file.print(F("THERMISTORS_STATISTICS_STOP\n\n"));
+    wait_while_card_busy();
 
     //
     sd_file.print(F("IRSENSOR_START\n"));
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
 
     sd_file.println(F("READING_NBR,POSIX_TIMESTAMP,IR_TEMP,SENSOR_TEMP,"));
 
@@ -179,23 +481,291 @@ void SD_Manager::log_data(void)
         sd_file.print(",");
         sd_file.print(crrt_reading_mlx.sensor_temperature);
         sd_file.println(",");
-        delay(10);
         wdt.restart();
     }
 
     sd_file.print(F("IRSENSOR_STOP\n\n"));
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
     //
 
+    if constexpr (sd_log_power_profile){
+        sd_file.print(F("POWER_PROFILE_START\n"));
+        sd_file.println(F("NAME,LAST,COUNT,MEAN,MAX,"));
+        for (size_t i=0; i<Power_Profiler::number_of_statistics; i++){
+            Power_Running_Statistics const & crrt_statistics = power_profiler.get_statistics(i);
+            sd_file.print(Power_Profiler::get_statistics_name(i));
+            sd_file.print(",");
+            sd_file.print(crrt_statistics.last);
+            sd_file.print(",");
+            sd_file.print(crrt_statistics.count);
+            sd_file.print(",");
+            sd_file.print(crrt_statistics.mean());
+            sd_file.print(",");
+            sd_file.print(crrt_statistics.max);
+            sd_file.println(",");
+        }
+        sd_file.print(F("POWER_PROFILE_STOP\n\n"));
+        wait_while_card_busy();
+    }
+
     sd_file.print(F("DATA-stop\n\n"));
-    delay(100);
-    wdt.restart();
+    wait_while_card_busy();
 
     stop();
-    delay(100);
+
+    LOG_PRINTLN(info, F("done log_data!"));
+}
+
+//--------------------------------------------------------------------------------
+// binary logging
+
+void SD_Manager::staging_start_block(void)
+{
+    staging_length = 0;
+    staging_crc = 0;
+    last_block_number_of_sectors = 0;
+    last_block_write_error = false;
+}
+
+void SD_Manager::staging_write_sector(void)
+{
+    if (sd_file.write(staging_buffer, sd_sector_size) != sd_sector_size)
+    {
+        LOG_PRINTLN(error, F("ERR staging sector write"));
+        trace_log.record(Trace_Event::sd_write_error, 0);
+        last_block_write_error = true;
+    }
     wdt.restart();
 
-    SERIAL_USB->println("done log_data!");
-    delay(100);
-}
\ No newline at end of file
+    staging_length = 0;
+    last_block_number_of_sectors += 1;
+    append_offset += sd_sector_size;
+}
+
+void SD_Manager::staging_append(void const * data, size_t size)
+{
+    uint8_t const * crrt_data = static_cast<uint8_t const *>(data);
+
+    staging_crc = binary_crc32_update(staging_crc, crrt_data, size);
+
+    while (size > 0)
+    {
+        size_t crrt_chunk = sd_sector_size - staging_length;
+        if (crrt_chunk > size)
+        {
+            crrt_chunk = size;
+        }
+
+        memcpy(&(staging_buffer[staging_length]), crrt_data, crrt_chunk);
+        staging_length += crrt_chunk;
+        crrt_data += crrt_chunk;
+        size -= crrt_chunk;
+
+        if (staging_length == sd_sector_size)
+        {
+            staging_write_sector();
+        }
+    }
+}
+
+void SD_Manager::staging_finish_block(void)
+{
+    // the CRC covers everything appended so far; take a copy, as appending updates it
+    uint32_t crc = staging_crc;
+    staging_append(&crc, sizeof(uint32_t));
+
+    // zero pad to the next sector boundary, so that the next block is sector aligned too
+    if (staging_length > 0)
+    {
+        memset(&(staging_buffer[staging_length]), 0, sd_sector_size - staging_length);
+        staging_write_sector();
+    }
+
+    LOG_PRINT(debug, F("wrote binary block, number of sectors: "));
+    LOG_PRINTLN(debug, last_block_number_of_sectors);
+    trace_log.record(Trace_Event::sd_block_written, last_block_number_of_sectors);
+}
+
+void SD_Manager::log_boot_binary(void)
+{
+    if constexpr (sd_file_mode != SD_File_Mode::one_file_per_wakeup){
+        boot_block_pending = true;
+        return;
+    }
+
+    // writing may itself record events; only write the ones recorded so far, that the
+    // header accounts for
+    uint32_t const number_of_trace_records = trace_log.size();
+
+    start_binary(boot_block_length(number_of_trace_records));
+    write_boot_block(number_of_trace_records);
+    bool const boot_block_written = !last_block_write_error;
+    stop();
+
+    // keep the trace for the next boot if it could not be written
+    if (boot_block_written){
+        trace_log.clear();
+    }
+}
+
+uint32_t SD_Manager::boot_block_length(uint32_t number_of_trace_records)
+{
+    return sizeof(Binary_Block_Header)
+           + sizeof(Binary_Section_Header) + number_of_trace_records * sizeof(Binary_Trace_Record)
+           + binary_block_crc_size;
+}
+
+void SD_Manager::write_boot_block(uint32_t number_of_trace_records)
+{
+    Binary_Block_Header header;
+    binary_init_block_header(header);
+    header.boot_number = boot_counter_instance.get_boot_number();
+    header.block_length = boot_block_length(number_of_trace_records);
+    header.posix_start = board_time_manager.get_posix_timestamp();
+    header.number_of_sections = 1;
+    header.block_type = static_cast<uint16_t>(Binary_Block_Type::boot);
+
+    staging_start_block();
+    staging_append(&header, sizeof(Binary_Block_Header));
+
+    // trace log
+    Binary_Section_Header section_header;
+    section_header.section_type = static_cast<uint16_t>(Binary_Section_Type::trace);
+    section_header.record_size = sizeof(Binary_Trace_Record);
+    section_header.number_of_records = number_of_trace_records;
+    staging_append(&section_header, sizeof(Binary_Section_Header));
+
+    Binary_Trace_Record trace_record;
+    for (uint32_t i=0; i<number_of_trace_records; i++){
+        Trace_Record const & crrt_record = trace_log.get_record(i);
+        trace_record.posix_timestamp = crrt_record.posix_timestamp;
+        trace_record.boot_number = crrt_record.boot_number;
+        trace_record.event = crrt_record.event;
+        trace_record.arg = crrt_record.arg;
+        staging_append(&trace_record, sizeof(Binary_Trace_Record));
+    }
+
+    staging_finish_block();
+}
+
+void SD_Manager::log_data_binary(void)
+{
+    LOG_PRINTLN(info, F("start log_data_binary..."));
+
+    size_t const number_of_thermistor_records = board_thermistors_manager.vector_of_readings.size();
+    size_t const number_of_thermistor_statistics_records = board_thermistors_manager.vector_of_statistics.size();
+    size_t const number_of_mlx_records = mlx90164_manager.crrt_accumulator_MLX.size();
+
+    // the header comes first in the file, so the full block length must be known upfront
+    Binary_Block_Header header;
+    binary_init_block_header(header);
+    header.boot_number = boot_counter_instance.get_boot_number();
+    header.block_length = sizeof(Binary_Block_Header)
+                          + sizeof(Binary_Section_Header) + number_of_thermistor_records * sizeof(Binary_Thermistor_Record)
+                          + sizeof(Binary_Section_Header) + number_of_thermistor_statistics_records * sizeof(Binary_Thermistor_Statistics_Record)
+                          + sizeof(Binary_Section_Header) + number_of_mlx_records * sizeof(Binary_MLX_Record)
+                          + binary_block_crc_size;
+    header.posix_start = board_thermistors_manager.posix_time_start;
+    header.number_of_sections = 3;
+
+    if constexpr (sd_log_power_profile){
+        header.block_length += sizeof(Binary_Section_Header)
+                               + Power_Profiler::number_of_statistics * sizeof(Binary_Power_Profile_Record);
+        header.number_of_sections += 1;
+    }
+
+    // the pending boot block goes first, in the same file
+    bool const with_boot_block = boot_block_pending;
+    uint32_t const number_of_trace_records = with_boot_block ? trace_log.size() : 0;
+    uint32_t const boot_block_padded_length = with_boot_block ? padded_block_length(boot_block_length(number_of_trace_records)) : 0;
+    bool boot_block_written {false};
+
+    start_binary(boot_block_padded_length + header.block_length);
+
+    if (with_boot_block){
+        write_boot_block(number_of_trace_records);
+        boot_block_written = !last_block_write_error;
+    }
+
+    staging_start_block();
+    staging_append(&header, sizeof(Binary_Block_Header));
+
+    // thermistors
+    Binary_Section_Header section_header;
+    section_header.section_type = static_cast<uint16_t>(Binary_Section_Type::thermistors);
+    section_header.record_size = sizeof(Binary_Thermistor_Record);
+    section_header.number_of_records = number_of_thermistor_records;
+    staging_append(&section_header, sizeof(Binary_Section_Header));
+
+    Binary_Thermistor_Record thermistor_record;
+    for (ThermistorReading const & crrt_reading : board_thermistors_manager.vector_of_readings){
+        thermistor_record.id = crrt_reading.id;
+        thermistor_record.raw = crrt_reading.raw;
+        staging_append(&thermistor_record, sizeof(Binary_Thermistor_Record));
+    }
+
+    // thermistors statistics
+    section_header.section_type = static_cast<uint16_t>(Binary_Section_Type::thermistor_statistics);
+    section_header.record_size = sizeof(Binary_Thermistor_Statistics_Record);
+    section_header.number_of_records = number_of_thermistor_statistics_records;
+    staging_append(&section_header, sizeof(Binary_Section_Header));
+
+    Binary_Thermistor_Statistics_Record statistics_record;
+    for (ThermistorStatistics const & crrt_statistics : board_thermistors_manager.vector_of_statistics){
+        statistics_record.id = crrt_statistics.id;
+        statistics_record.count = crrt_statistics.count;
+        statistics_record.sum_raw = crrt_statistics.sum_raw;
+        statistics_record.sum_squares_raw = crrt_statistics.sum_squares_raw;
+        statistics_record.min_raw = crrt_statistics.min_raw;
+        statistics_record.max_raw = crrt_statistics.max_raw;
+        statistics_record.crc_failures = crrt_statistics.crc_failures;
+        staging_append(&statistics_record, sizeof(Binary_Thermistor_Statistics_Record));
+    }
+
+    // IR sensor
+    section_header.section_type = static_cast<uint16_t>(Binary_Section_Type::mlx);
+    section_header.record_size = sizeof(Binary_MLX_Record);
+    section_header.number_of_records = number_of_mlx_records;
+    staging_append(&section_header, sizeof(Binary_Section_Header));
+
+    Binary_MLX_Record mlx_record;
+    for (MLX_Information const & crrt_reading_mlx : mlx90164_manager.crrt_accumulator_MLX){
+        mlx_record.posix_timestamp = crrt_reading_mlx.posix_timestamp;
+        mlx_record.ir_temperature = crrt_reading_mlx.ir_temperature;
+        mlx_record.sensor_temperature = crrt_reading_mlx.sensor_temperature;
+        staging_append(&mlx_record, sizeof(Binary_MLX_Record));
+    }
+
+    // power profile; the statistics of the previous wakeups, the current one is still running
+    if constexpr (sd_log_power_profile){
+        section_header.section_type = static_cast<uint16_t>(Binary_Section_Type::power_profile);
+        section_header.record_size = sizeof(Binary_Power_Profile_Record);
+        section_header.number_of_records = Power_Profiler::number_of_statistics;
+        staging_append(&section_header, sizeof(Binary_Section_Header));
+
+        Binary_Power_Profile_Record power_record;
+        memset(&power_record, 0, sizeof(Binary_Power_Profile_Record));
+        for (size_t i=0; i<Power_Profiler::number_of_statistics; i++){
+            Power_Running_Statistics const & crrt_statistics = power_profiler.get_statistics(i);
+            power_record.statistics_index = static_cast<uint8_t>(i);
+            power_record.last = crrt_statistics.last;
+            power_record.count = crrt_statistics.count;
+            power_record.mean = crrt_statistics.mean();
+            power_record.max = crrt_statistics.max;
+            staging_append(&power_record, sizeof(Binary_Power_Profile_Record));
+        }
+    }
+
+    staging_finish_block();
+
+    stop();
+
+    // stop() reboots if the file cannot be closed, so the trace is on the card; keep it for
+    // the next data block if it could not be written
+    if (boot_block_written){
+        boot_block_pending = false;
+        trace_log.clear();
+    }
+
+    LOG_PRINTLN(info, F("done log_data_binary!"));
+}
@@ -4,6 +4,7 @@
 #include "firmware_configuration.h"
 #include "user_configuration.h"
 #include "print_utils.h"
+#include "log_utils.h"
 
 #include <SPI.h>
 #include "SdFat.h"
@@ -17,6 +18,10 @@
 #include "thermistors_manager.h"
 #include "mlx90164_manager.h"
 
+#include "binary_format.h"
+#include "power_profiler.h"
+#include "trace_log.h"
+
 // which kind of card format is used
 // this is what works on my 32 GB SD card
 typedef SdFs sd_t;
@@ -30,18 +35,107 @@ class SD_Manager{
         // update filename based on the UTC clock value
         void update_filename();
 
-        // write a boot log message
+        // write a boot log message, followed by the trace log (see trace_log.h); the
+        // trace log is cleared once written. In the binary preallocated modes, this is
+        // done with the first log_data of the boot
         void log_boot(void);
 
         // write a full data file
+        // this is either a binary block or ASCII text, depending on sd_log_data_binary
         void log_data(void);
 
+        // the length taken in the file by a block, i.e. padded to the next sector boundary
+        static constexpr uint32_t padded_block_length(uint32_t block_length){
+            return (block_length + sd_sector_size - 1) / sd_sector_size * sd_sector_size;
+        }
+
     private:
+        // write the data as ASCII text, with one print per field
+        void log_data_ascii(void);
+
+        // write the data as a single binary block, see binary_format.h
+        void log_data_binary(void);
+
+        // write a binary boot block, holding the boot information and the trace log; in the
+        // preallocated modes, it is only marked pending, and written by log_data_binary
+        // just before the first data block of the boot: by then the RTC is set, so that the
+        // boot block goes to the per-day file of the data, and no file is created and
+        // preallocated for a single boot sector at each power cycle
+        void log_boot_binary(void);
+        bool boot_block_pending {false};
+
+        // the length of the boot block with number_of_trace_records, and its writing; the
+        // file must be open and positioned
+        static uint32_t boot_block_length(uint32_t number_of_trace_records);
+        void write_boot_block(uint32_t number_of_trace_records);
+
+        // the binary block is serialized into a sector sized staging buffer, that is written
+        // to the SD card as whole sectors each time it is full; the end of the block is
+        // zero padded to the next sector boundary, so that the next block is also sector
+        // aligned. This way SdFat never needs to do a partial sector read-modify-write,
+        // and never uses its internal cache for the data.
+        // the SD card must be started, and the file open, when using these.
+        void staging_start_block(void);
+        void staging_append(void const * data, size_t size);
+        void staging_finish_block(void);
+        void staging_write_sector(void);
+
+        static constexpr size_t sd_sector_size {512};
+        static_assert(sd_sector_size == binary_block_alignment, "binary blocks must be sector aligned");
+
+        alignas(4) uint8_t staging_buffer[sd_sector_size];
+        size_t staging_length {0};
+        uint32_t staging_crc {0};
+
+        // statistics about the last block written
+        uint32_t last_block_number_of_sectors {0};
+        bool last_block_write_error {false};
+
         // make everything ready to use
         // start the SD card, SPI etc
         // open file
         void start();
 
+        // start the SD card, SPI etc, without opening any file
+        void start_card();
+
+        // wait as long as the card reports that it is busy (i.e. holds MISO low while
+        // programming flash), and no longer; the time spent waiting goes to the sd_busy
+        // power profile statistics. Gives up after sd_busy_timeout_us, in which case the
+        // next SdFat operation will report the error.
+        void wait_while_card_busy();
+
+        static constexpr unsigned long sd_busy_timeout_us {500000UL};
+
+        // make everything ready to write a binary block of block_length bytes
+        // start the SD card, open the file, and position the file where the block goes;
+        // in the preallocated modes, this creates and preallocates the file if needed, and
+        // rolls over to a new file if the current one is full. A block larger than a
+        // preallocated file goes to its own file, named as in one_file_per_wakeup
+        void start_binary(uint32_t block_length);
+
+        // open the current preallocated file, creating and preallocating it if needed,
+        // and make sure that append_offset is valid for it
+        void open_preallocated_file();
+
+        // find where the next block goes in the current preallocated file, by walking
+        // through the blocks already written during this boot; this is needed only
+        // after a reboot, or when changing file
+        uint32_t find_append_offset();
+
+        // in the preallocated modes, where the next block is written in the current file
+        // this is kept in RAM, that is retained during sleep
+        uint32_t append_offset {0};
+        bool append_offset_valid {false};
+        char preallocated_filename[32] {'\0'};
+
+        // rollover index of the preallocated file, and the day it is used for
+        uint16_t file_rollover_index {0};
+        uint32_t file_rollover_day {0};
+
+        // the filename of the one_file_per_wakeup mode, from the UTC clock value
+        void update_filename_per_wakeup();
+
         // stop the SD logging, to be ready to sleep etc
         // close file
         // stop SD card, SPI etc
@@ -84,7 +84,7 @@ void sleep_for_seconds(unsigned long const number_of_seconds)
 {
   if (number_of_seconds > max_sleep_seconds)
   {
-    if (USE_SERIAL_PRINT)
+    if constexpr (LOG_ENABLED(warning))
     {
       PRINT_VAR(number_of_seconds);
       SERIAL_USB->println(F(" is suspicious; cut!"));
@@ -93,12 +93,14 @@ void sleep_for_seconds(unsigned long const number_of_seconds)
     return;
   }
 
-  if (USE_SERIAL_PRINT){
+  if constexpr (LOG_ENABLED(info)){
     SERIAL_USB->print(F("sleep for "));
     SERIAL_USB->print(number_of_seconds);
     SERIAL_USB->println(F(" seconds"));
   }
 
+  trace_log.record(Trace_Event::sleep, number_of_seconds);
+
   hal_prepare_to_sleep();
   user_sleep_pre_actions();
 
@@ -134,11 +136,106 @@ void sleep_for_seconds(unsigned long const number_of_seconds)
   hal_wake_up();
   user_sleep_post_actions();
 
+  trace_log.record(Trace_Event::wakeup);
+  LOG_PRINT(info, F("wakeup"));
+}
+
+//--------------------------------------------------------------------------------
+// short sleeps, timed with a CTIMER; see example_user_ctimer_interrupts for the CTIMER setup
+
+// the CTIMER used to wake up, and its interrupt flag
+static constexpr uint32_t short_sleep_ctimer_number {2};
+static constexpr uint32_t short_sleep_ctimer_interrupt {AM_HAL_CTIMER_INT_TIMERA2};
+static constexpr uint64_t short_sleep_ctimer_hz {32768};
+
+// below this, waking up costs about as much as staying awake
+static constexpr unsigned long min_short_sleep_ms {3};
+// longer sleeps are split, to fit the 16 bits CTIMER segment and restart the watchdog
+static constexpr unsigned long max_short_sleep_chunk_ms {1000};
+static_assert(max_short_sleep_chunk_ms * short_sleep_ctimer_hz / 1000 <= 0xFFFF);
+
+static volatile bool short_sleep_timer_expired {false};
+static uint64_t micros_in_short_sleeps {0};
+
+extern "C" void am_ctimer_isr(void)
+{
+  uint32_t const status = am_hal_ctimer_int_status_get(true);
+  am_hal_ctimer_int_clear(status);
+
+  if (status & short_sleep_ctimer_interrupt)
+  {
+    short_sleep_timer_expired = true;
+  }
+}
+
+void sleep_for_milliseconds(unsigned long const number_of_milliseconds)
+{
+  if (number_of_milliseconds < min_short_sleep_ms)
+  {
+    delay(number_of_milliseconds);
+    return;
+  }
+
+  // the UART would be stopped in the middle of a transfer
   if (USE_SERIAL_PRINT){
-    SERIAL_USB->print(F("wakeup"));
+    SERIAL_USB->flush();
+  }
+
+  unsigned long remaining_ms {number_of_milliseconds};
+
+  while (remaining_ms > 0)
+  {
+    unsigned long const crrt_ms = (remaining_ms > max_short_sleep_chunk_ms) ? max_short_sleep_chunk_ms : remaining_ms;
+    uint32_t const number_of_ticks = static_cast<uint32_t>((crrt_ms * short_sleep_ctimer_hz + 500) / 1000);
+
+    am_hal_ctimer_stop(short_sleep_ctimer_number, AM_HAL_CTIMER_TIMERA);
+    am_hal_ctimer_clear(short_sleep_ctimer_number, AM_HAL_CTIMER_TIMERA);
+    am_hal_ctimer_config_single(short_sleep_ctimer_number, AM_HAL_CTIMER_TIMERA,
+                                (AM_HAL_CTIMER_FN_ONCE |
+                                 AM_HAL_CTIMER_XT_32_768KHZ |
+                                 AM_HAL_CTIMER_INT_ENABLE));
+    am_hal_ctimer_compare_set(short_sleep_ctimer_number, AM_HAL_CTIMER_TIMERA, 0, number_of_ticks);
+    am_hal_ctimer_int_clear(short_sleep_ctimer_interrupt);
+    am_hal_ctimer_int_enable(short_sleep_ctimer_interrupt);
+    NVIC_EnableIRQ(CTIMER_IRQn);
+
+    // the system timer would run on the HFRC, that is stopped in deep sleep
+    uint32_t const stimer_config = am_hal_stimer_config(AM_HAL_STIMER_CFG_FREEZE);
+
+    short_sleep_timer_expired = false;
+    am_hal_ctimer_start(short_sleep_ctimer_number, AM_HAL_CTIMER_TIMERA);
+
+    // the RTC wakes us up every second too; with interrupts masked, a timer interrupt that
+    // comes after the check still wakes up the core, and is serviced when unmasking
+    noInterrupts();
+    while (!short_sleep_timer_expired)
+    {
+      am_hal_sysctrl_sleep(AM_HAL_SYSCTRL_SLEEP_DEEP);
+      interrupts();
+      noInterrupts();
+    }
+    interrupts();
+
+    am_hal_stimer_config(stimer_config);
+    am_hal_ctimer_int_disable(short_sleep_ctimer_interrupt);
+    am_hal_ctimer_stop(short_sleep_ctimer_number, AM_HAL_CTIMER_TIMERA);
+
+    micros_in_short_sleeps += static_cast<uint64_t>(number_of_ticks) * 1000000ULL / short_sleep_ctimer_hz;
+    remaining_ms -= crrt_ms;
+    wdt.restart();
   }
 }
 
+unsigned long sleep_aware_millis(void)
+{
+  return millis() + static_cast<unsigned long>(micros_in_short_sleeps / 1000ULL);
+}
+
+unsigned long sleep_aware_micros(void)
+{
+  return micros() + static_cast<unsigned long>(micros_in_short_sleeps);
+}
+
 unsigned long seconds_to_sleep_until_posix(kiss_time_t const posix_timestamp)
 {
   unsigned long number_seconds_to_sleep{0};
@@ -148,17 +245,13 @@ unsigned long seconds_to_sleep_until_posix(kiss_time_t const posix_timestamp)
     number_seconds_to_sleep = posix_timestamp - board_time_manager.get_posix_timestamp();
     if (number_seconds_to_sleep > max_sleep_seconds)
     {
-      if (USE_SERIAL_PRINT){
-        SERIAL_USB->println(F("W suspicious posix sleep duration; cut!"));
-      }
+      LOG_PRINTLN(warning, F("W suspicious posix sleep duration; cut!"));
       number_seconds_to_sleep = max_sleep_seconds;
     }
   }
   else
   {
-    if (USE_SERIAL_PRINT){
-      SERIAL_USB->println(F("W invalid posix; sleep default duration"));
-    }
+    LOG_PRINTLN(warning, F("W invalid posix; sleep default duration"));
     number_seconds_to_sleep = max_sleep_seconds;
   }
 
@@ -167,7 +260,7 @@ unsigned long seconds_to_sleep_until_posix(kiss_time_t const posix_timestamp)
 
 void sleep_until_posix(kiss_time_t const posix_timestamp)
 {
-  if (USE_SERIAL_PRINT){
+  if constexpr (LOG_ENABLED(info)){
     SERIAL_USB->print(F("Sleep until posix "));
     SERIAL_USB->println(posix_timestamp);
   }
@@ -6,7 +6,9 @@
 #include "firmware_configuration.h"
 #include "time_manager.h"
 #include "user_configuration.h"
+#include "log_utils.h"
 #include "watchdog_manager.h"
+#include "trace_log.h"
 
 
 // NOTE: could put in an own namespace, but a bit heavier to use
@@ -18,6 +20,18 @@ void sleep_for_seconds(unsigned long const number_of_seconds);
 
 void sleep_until_posix(kiss_time_t const posix_timestamp);
 
+// deep sleep for a short duration, e.g. while the sensors are busy converting; woken by a
+// one shot CTIMER on the 32kHz crystal. Unlike sleep_for_seconds, the peripherals, pads,
+// and serial port are left as they are, so this can be used in the middle of a measurement.
+// very short durations are simply delay()ed.
+void sleep_for_milliseconds(unsigned long const number_of_milliseconds);
+
+// millis() and micros() do not advance during sleep_for_milliseconds (the system timer is
+// frozen, as it would run on a stopped clock); these add the time spent in it, to measure
+// durations that include short sleeps. Both wrap around as millis() and micros() do.
+unsigned long sleep_aware_millis(void);
+unsigned long sleep_aware_micros(void);
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // ideally the following would be "hidden" by not sharing in the header file, but for now
 // keep it here, as we want to test it in the unit tests
@@ -12,7 +12,9 @@ float float_mean_filter(etl::ivector<float> const & vec_in){
 float float_sigma_filter(etl::ivector<float> const & vec_in, float n_sigma){
   // if empty vector print error message and return 0
   if (vec_in.size() == 0){
-    Serial.println(F("WARNING!!! take sigma filter of empty vec"));
+    #if STAT_PROCESSING_VERBOSE
+      Serial.println(F("WARNING!!! take sigma filter of empty vec"));
+    #endif
     return 0.0f;
   }
 
@@ -26,7 +28,9 @@ float float_sigma_filter(etl::ivector<float> const & vec_in, float n_sigma){
     }
   }
   if (all_equal){
-    Serial.println(F("WARNING!!! take sigma filter of all equal vec"));
+    #if STAT_PROCESSING_VERBOSE
+      Serial.println(F("WARNING!!! take sigma filter of all equal vec"));
+    #endif
     return (vec_in[0]);
   }
 
@@ -57,8 +61,10 @@ float float_sigma_filter(etl::ivector<float> const & vec_in, float n_sigma){
       nbr_of_ok_values++;
     }
     else{
-      Serial.print(F("outlier ")); Serial.print(vec_in[ind]);
-      print_vector = true;
+      #if STAT_PROCESSING_VERBOSE
+        Serial.print(F("outlier ")); Serial.print(vec_in[ind]);
+        print_vector = true;
+      #endif
     }
   }
   sigma_average /= nbr_of_ok_values;
@@ -1,23 +1,305 @@
 #ifndef STAT_PROCESSING
 #define STAT_PROCESSING
 
+// before Arduino.h, that may define min / max macros
+#include <algorithm>
+
 #include "Arduino.h"
 
 #include "etl/vector.h"
 
 #include "math.h"
+#include <cmath>
+#include <type_traits>
 
 #ifndef STAT_PROCESSING_VERBOSE
   #define STAT_PROCESSING_VERBOSE 0
 #endif
 
+// integer division rounded to the nearest, half away from zero
+inline int64_t rounded_division(int64_t numerator, int64_t denominator){
+  return (numerator >= 0) ? (numerator + denominator / 2) / denominator : -((-numerator + denominator / 2) / denominator);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// n-sigma filter: the mean of the values within n_sigma standard deviations of the mean
+//
+// sigma_filter makes two passes over the data, and works on the offsets to the first
+// value, so that there is no overflow and no loss of accuracy for large values close to
+// each other (e.g. lat and lon in 1e-7 degrees as long):
+//   - pass 1: mean and std of all the values, from the sum of the offsets (in Sum) and the
+//     sum of their squares (in Real); with the offsets to a value of the data, there is no
+//     catastrophic cancellation, and no division per value as with Welford's update
+//   - pass 2: the sum of the offsets of the values kept, in Sum; the mean is exact
+//     (rounded to the nearest) when Sum is an integral type
+// by default, Sum is int64_t for integral T and T otherwise, and Real is float, that is in
+// hardware on the Cortex-M4F (double is emulated in software); the std only decides which
+// values are kept, so float is accurate enough for it.
+// for a one-pass variant on a stream of values, see Streaming_Robust_Mean below. The
+// former implementations, accurate_sigma_filter and float_sigma_filter, are kept for
+// comparison, see benchmark/.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T, typename Real>
+struct Sigma_Filter_Result{
+  T mean;                     // the mean of the values kept; 0 if no values
+  Real std;                   // the std of all the values (population), used for the rejection
+  size_t count_kept;
+  size_t number_of_outliers;
+};
+
+template <typename T>
+using sigma_filter_sum_t = typename std::conditional<std::is_integral<T>::value, int64_t, T>::type;
+
+template <typename T, typename Sum = sigma_filter_sum_t<T>, typename Real = float>
+Sigma_Filter_Result<T, Real> sigma_filter(etl::ivector<T> const & vec_in, Real n_sigma = 2){
+  static_assert(std::is_signed<T>::value, "signed values only; the offsets to the first value are signed");
+  static_assert(std::is_signed<Sum>::value, "signed accumulator only");
+
+  Sigma_Filter_Result<T, Real> result {0, 0, 0, 0};
+
+  if (vec_in.size() == 0){
+    return result;
+  }
+
+  // see accurate_sigma_filter about this minimum
+  if (n_sigma < Real(1.5)){
+    n_sigma = Real(1.5);
+  }
+
+  T const reference = vec_in[0];
+
+  // pass 1: mean and std of the offsets
+  Sum sum_offsets {0};
+  Real sum_squares {0};
+  for (T const & crrt_value : vec_in){
+    Sum const offset = static_cast<Sum>(crrt_value) - static_cast<Sum>(reference);
+    sum_offsets += offset;
+    sum_squares += static_cast<Real>(offset) * static_cast<Real>(offset);
+  }
+
+  Real const count = static_cast<Real>(vec_in.size());
+  Real const mean_offset = static_cast<Real>(sum_offsets) / count;
+  Real const variance = sum_squares / count - mean_offset * mean_offset;
+  result.std = (variance > 0) ? std::sqrt(variance) : Real(0);
+  Real const max_distance = n_sigma * result.std;
+
+  // pass 2: the sum of the offsets kept; with all the values equal, std is 0 and all are kept
+  Sum sum_kept {0};
+  for (T const & crrt_value : vec_in){
+    Sum const offset = static_cast<Sum>(crrt_value) - static_cast<Sum>(reference);
+    if (std::fabs(static_cast<Real>(offset) - mean_offset) <= max_distance){
+      sum_kept += offset;
+      result.count_kept += 1;
+    }
+  }
+
+  // at least one value is within 1 std of the mean, so count_kept > 0; but be safe against
+  // rounding, and fall back to the plain mean
+  if (result.count_kept == 0){
+    sum_kept = sum_offsets;
+    result.count_kept = vec_in.size();
+  }
+
+  result.number_of_outliers = vec_in.size() - result.count_kept;
+
+  if constexpr (std::is_integral<Sum>::value){
+    result.mean = static_cast<T>(static_cast<Sum>(reference) + rounded_division(sum_kept, static_cast<Sum>(result.count_kept)));
+  }
+  else{
+    result.mean = static_cast<T>(static_cast<Sum>(reference) + sum_kept / static_cast<Sum>(result.count_kept));
+  }
+
+  return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// order statistics: median, MAD filter, trimmed mean
+//
+// unlike the n-sigma filters, where the mean and std that decide what is an outlier are
+// computed with the outliers in, these are robust to up to half (median, MAD filter) or
+// trim_fraction (trimmed mean) of outliers. They use in place selection (std::nth_element,
+// O(n) on average, no heap), so they REORDER the values of vec_in; copy first if the order
+// matters. The deviations are computed in Sum / Real, as the difference of two values may
+// not fit in T.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// twice the median, exact in Sum also for an even number of values; the values are
+// reordered around the middle; vec_in must not be empty
+template <typename T, typename Sum = sigma_filter_sum_t<T>>
+Sum twice_median_in_place(etl::ivector<T> & vec_in){
+  size_t const n = vec_in.size();
+  size_t const middle = n / 2;
+  std::nth_element(vec_in.begin(), vec_in.begin() + middle, vec_in.end());
+  if (n % 2 == 1){
+    return 2 * static_cast<Sum>(vec_in[middle]);
+  }
+
+  // the values before the middle one are all lower or equal: the other middle value is the
+  // largest of them
+  T const lower_middle = *std::max_element(vec_in.begin(), vec_in.begin() + middle);
+  return static_cast<Sum>(lower_middle) + static_cast<Sum>(vec_in[middle]);
+}
+
+// half of a Sum, rounded to the nearest for integral types
+template <typename T, typename Sum>
+T half_of(Sum twice_value){
+  if constexpr (std::is_integral<Sum>::value){
+    return static_cast<T>(rounded_division(twice_value, 2));
+  }
+  else{
+    return static_cast<T>(twice_value / 2);
+  }
+}
+
+// the median; for an even number of values, the mean of the two middle ones (rounded to
+// the nearest for integral types); 0 if empty
+template <typename T, typename Sum = sigma_filter_sum_t<T>>
+T median_in_place(etl::ivector<T> & vec_in){
+  if (vec_in.size() == 0){
+    return 0;
+  }
+
+  return half_of<T, Sum>(twice_median_in_place<T, Sum>(vec_in));
+}
+
+// the median of the absolute deviations to the median given as twice_median; see
+// median_absolute_deviation_in_place
+template <typename T, typename Sum = sigma_filter_sum_t<T>, typename Real = float>
+Real median_absolute_deviation_around_in_place(etl::ivector<T> & vec_in, Sum twice_median){
+  // twice the deviation, to stay exact with an even number of values
+  auto const twice_deviation = [twice_median](T value){
+    return std::fabs(static_cast<Real>(2 * static_cast<Sum>(value) - twice_median));
+  };
+  auto const closer = [&twice_deviation](T a, T b){ return twice_deviation(a) < twice_deviation(b); };
+
+  size_t const n = vec_in.size();
+  size_t const middle = n / 2;
+  std::nth_element(vec_in.begin(), vec_in.begin() + middle, vec_in.end(), closer);
+  if (n % 2 == 1){
+    return twice_deviation(vec_in[middle]) / 2;
+  }
+
+  T const lower_middle = *std::max_element(vec_in.begin(), vec_in.begin() + middle, closer);
+  return (twice_deviation(lower_middle) + twice_deviation(vec_in[middle])) / 4;
+}
+
+// the median absolute deviation (MAD), i.e. the median of the absolute deviations to the
+// median; 0 if empty
+template <typename T, typename Sum = sigma_filter_sum_t<T>, typename Real = float>
+Real median_absolute_deviation_in_place(etl::ivector<T> & vec_in){
+  if (vec_in.size() == 0){
+    return 0;
+  }
+
+  Sum const twice_median = twice_median_in_place<T, Sum>(vec_in);
+  return median_absolute_deviation_around_in_place<T, Sum, Real>(vec_in, twice_median);
+}
+
+// the mean of the values within n_sigma robust standard deviations of the median, the
+// robust standard deviation being 1.4826 * MAD (i.e. the std for normally distributed
+// values); returned as the std of the result. If more than half of the values are equal,
+// the MAD is 0 and only these are kept.
+template <typename T, typename Sum = sigma_filter_sum_t<T>, typename Real = float>
+Sigma_Filter_Result<T, Real> mad_filter_in_place(etl::ivector<T> & vec_in, Real n_sigma = 3){
+  Sigma_Filter_Result<T, Real> result {0, 0, 0, 0};
+
+  if (vec_in.size() == 0){
+    return result;
+  }
+
+  Sum const twice_median = twice_median_in_place<T, Sum>(vec_in);
+  T const median_value = half_of<T, Sum>(twice_median);
+  result.std = Real(1.4826) * median_absolute_deviation_around_in_place<T, Sum, Real>(vec_in, twice_median);
+  Real const twice_max_distance = 2 * n_sigma * result.std;
+
+  // the sum of the offsets to median_value, that is a value close to the data
+  Sum sum_kept {0};
+  for (T const & crrt_value : vec_in){
+    if (std::fabs(static_cast<Real>(2 * static_cast<Sum>(crrt_value) - twice_median)) <= twice_max_distance){
+      sum_kept += static_cast<Sum>(crrt_value) - static_cast<Sum>(median_value);
+      result.count_kept += 1;
+    }
+  }
+
+  // for an even number of values, the median may be between two values that are both
+  // further than the max distance, when the MAD is 0
+  if (result.count_kept == 0){
+    result.mean = median_value;
+    result.number_of_outliers = vec_in.size();
+    return result;
+  }
+
+  result.number_of_outliers = vec_in.size() - result.count_kept;
+
+  if constexpr (std::is_integral<Sum>::value){
+    result.mean = static_cast<T>(static_cast<Sum>(median_value) + rounded_division(sum_kept, static_cast<Sum>(result.count_kept)));
+  }
+  else{
+    result.mean = static_cast<T>(static_cast<Sum>(median_value) + sum_kept / static_cast<Sum>(result.count_kept));
+  }
+
+  return result;
+}
+
+// the mean without the floor(trim_fraction * n) lowest and highest values; the std of the
+// result is the std of the values kept. At least one value is always kept.
+template <typename T, typename Sum = sigma_filter_sum_t<T>, typename Real = float>
+Sigma_Filter_Result<T, Real> trimmed_mean_in_place(etl::ivector<T> & vec_in, Real trim_fraction = Real(0.1)){
+  Sigma_Filter_Result<T, Real> result {0, 0, 0, 0};
+
+  size_t const n = vec_in.size();
+  if (n == 0){
+    return result;
+  }
+
+  size_t number_to_trim = static_cast<size_t>(trim_fraction * static_cast<Real>(n));
+  if (2 * number_to_trim >= n){
+    number_to_trim = (n - 1) / 2;
+  }
+
+  // the lowest values first, then the highest ones last
+  if (number_to_trim > 0){
+    std::nth_element(vec_in.begin(), vec_in.begin() + number_to_trim, vec_in.end());
+    std::nth_element(vec_in.begin() + number_to_trim, vec_in.end() - number_to_trim, vec_in.end());
+  }
+
+  T const reference = vec_in[number_to_trim];
+  Sum sum_offsets {0};
+  Real sum_squares {0};
+  for (size_t ind=number_to_trim; ind<n-number_to_trim; ind++){
+    Sum const offset = static_cast<Sum>(vec_in[ind]) - static_cast<Sum>(reference);
+    sum_offsets += offset;
+    sum_squares += static_cast<Real>(offset) * static_cast<Real>(offset);
+  }
+
+  result.count_kept = n - 2 * number_to_trim;
+  result.number_of_outliers = 2 * number_to_trim;
+
+  Real const count = static_cast<Real>(result.count_kept);
+  Real const mean_offset = static_cast<Real>(sum_offsets) / count;
+  Real const variance = sum_squares / count - mean_offset * mean_offset;
+  result.std = (variance > 0) ? std::sqrt(variance) : Real(0);
+
+  if constexpr (std::is_integral<Sum>::value){
+    result.mean = static_cast<T>(static_cast<Sum>(reference) + rounded_division(sum_offsets, static_cast<Sum>(result.count_kept)));
+  }
+  else{
+    result.mean = static_cast<T>(static_cast<Sum>(reference) + sum_offsets / static_cast<Sum>(result.count_kept));
+  }
+
+  return result;
+}
+
 float float_mean_filter(etl::ivector<float> const & vec_in);
 
+// the former float n-sigma filter (3 passes, std with n-1); see sigma_filter
 float float_sigma_filter(etl::ivector<float> const & vec_in, float n_sigma=2.0);
 
 // a n-sigma filter, i.e. compute the mean based on only the values of the array that are with n standard deviations of the mean
 // we do it here taking great care to not overflow and keep as high accuracy as possible; this is in case we for example use some integral types
 // and need high accuracy on these (for example, working with lat and lon data represented as int or long)
+// this is the former implementation, in double and with 4 to 5 passes; see sigma_filter
 template <typename T>
 T accurate_sigma_filter(etl::ivector<T> const & vec_in, double n_sigma=2.0, bool verbose=false){
   static_assert(std::is_signed<T>::value, "signed values only; we rely on signed arithmetics to compute the mean while avoiding overflows");
@@ -141,6 +423,149 @@ T accurate_sigma_filter(etl::ivector<T> const & vec_in, double n_sigma=2.0, bool
   return (coarse_mean + fine_mean);
 }
 
+// a streaming alternative to accurate_sigma_filter: the mean and standard deviation are
+// updated at each sample, in O(1) memory, and a new sample further than n_sigma standard
+// deviations from the current mean is an outlier (to drop with push_if_not_outlier, or with
+// is_outlier, push, and reject to drop samples of several estimators together). This
+// allows to stop taking samples as soon as the mean is accurate enough, see standard_error.
+// the mean is over the samples kept; they are stored as offsets to the first sample, in
+// int64_t, so that the mean is exact integer arithmetics for any signed integral T (e.g. lat
+// and lon in 1e-7 degrees).
+// the standard deviation also counts the rejected samples, clipped to the rejection
+// distance (Welford's update): without them, the standard deviation of the samples kept can
+// only shrink, and more and more good samples get rejected. As in sigma_filter, it is in
+// float, that is in hardware on the Cortex-M4F: it works on the offsets to the first
+// sample, that are small (a few meters of GNSS noise are a few 100s of 1e-7 degrees), so
+// there is no cancellation, and it only decides which samples are kept.
+// the first number_of_warmup_samples are always kept, as the standard deviation is
+// meaningless before; the standard deviation used for the rejection is at least
+// minimum_sigma, so that a run of equal samples does not reject everything after it.
+template <typename T>
+class Streaming_Robust_Mean{
+  static_assert(std::is_signed<T>::value, "signed values only; the offsets to the first sample are signed");
+
+  public:
+    Streaming_Robust_Mean(float n_sigma=2.0f, T minimum_sigma=1, size_t number_of_warmup_samples=5):
+      n_sigma{n_sigma < 1.5f ? 1.5f : n_sigma}, minimum_sigma{minimum_sigma}, number_of_warmup_samples{number_of_warmup_samples}
+    {}
+
+    void clear(void){
+      number_of_samples = 0;
+      number_of_rejected_samples = 0;
+      sum_offsets = 0;
+      welford_mean = 0.0f;
+      welford_m2 = 0.0f;
+    }
+
+    // whether the sample is too far from the current mean
+    bool is_outlier(T value) const {
+      if (number_of_samples < number_of_warmup_samples){
+        return false;
+      }
+
+      return std::fabs(offset_of(value) - mean_offset()) > rejection_distance();
+    }
+
+    // push the sample if not an outlier, reject it otherwise; return false if rejected
+    bool push_if_not_outlier(T value){
+      if (is_outlier(value)){
+        reject(value);
+        return false;
+      }
+
+      push(value);
+      return true;
+    }
+
+    // keep the sample, outlier or not
+    void push(T value){
+      if (number_of_samples == 0){
+        reference = value;
+      }
+
+      int64_t const offset = static_cast<int64_t>(value) - static_cast<int64_t>(reference);
+      number_of_samples += 1;
+      sum_offsets += offset;
+      welford_update(static_cast<float>(offset));
+    }
+
+    // drop the sample, outlier or not; it only counts in the standard deviation, clipped to
+    // the rejection distance
+    void reject(T value){
+      if (number_of_samples == 0){
+        return;
+      }
+
+      // the distance that is_outlier compared with, i.e. before this sample counts in the std
+      float const distance = offset_of(value) - mean_offset();
+      float const max_distance = rejection_distance();
+      float const clipped_distance = std::fmax(-max_distance, std::fmin(max_distance, distance));
+
+      number_of_rejected_samples += 1;
+      welford_update(mean_offset() + clipped_distance);
+    }
+
+    size_t count(void) const { return number_of_samples; }
+    size_t rejected(void) const { return number_of_rejected_samples; }
+
+    // the mean of the samples kept, rounded to the nearest; 0 if no samples
+    T mean(void) const {
+      if (number_of_samples == 0){
+        return 0;
+      }
+      return static_cast<T>(static_cast<int64_t>(reference) + rounded_division(sum_offsets, static_cast<int64_t>(number_of_samples)));
+    }
+
+    // the standard deviation, rejected samples included as clipped, see above
+    float std(void) const {
+      size_t const n = number_of_samples + number_of_rejected_samples;
+      if (n < 2){
+        return 0.0f;
+      }
+      return std::sqrt(welford_m2 / static_cast<float>(n));
+    }
+
+    // the standard error of the mean, std / sqrt(count); this assumes independent samples,
+    // so it is optimistic for strongly correlated samples
+    float standard_error(void) const {
+      if (number_of_samples < 2){
+        return INFINITY;
+      }
+      return std() / std::sqrt(static_cast<float>(number_of_samples));
+    }
+
+  private:
+    float offset_of(T value) const {
+      return static_cast<float>(static_cast<int64_t>(value) - static_cast<int64_t>(reference));
+    }
+
+    float mean_offset(void) const {
+      return static_cast<float>(sum_offsets) / static_cast<float>(number_of_samples);
+    }
+
+    float rejection_distance(void) const {
+      return n_sigma * std::fmax(std(), static_cast<float>(minimum_sigma));
+    }
+
+    void welford_update(float offset){
+      size_t const n = number_of_samples + number_of_rejected_samples;
+      float const delta = offset - welford_mean;
+      welford_mean += delta / static_cast<float>(n);
+      welford_m2 += delta * (offset - welford_mean);
+    }
+
+    float n_sigma;
+    T minimum_sigma;
+    size_t number_of_warmup_samples;
+
+    T reference {0};
+    size_t number_of_samples {0};
+    size_t number_of_rejected_samples {0};
+    int64_t sum_offsets {0};
+    float welford_mean {0.0f};  // of the offsets, for the standard deviation
+    float welford_m2 {0.0f};
+};
+
 // TODO: change to modern looping
 // TODO: provide also the std in the same way
 
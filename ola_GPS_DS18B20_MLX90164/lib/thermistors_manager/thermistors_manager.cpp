@@ -22,6 +22,22 @@ void uint64_t_to_address(uint64_t const &uint64_in, Address &addr_out)
     }
 }
 
+// the configuration register of the scratchpad: resolution in bits 5-6, the other bits
+// read as 1
+byte resolution_to_config(uint8_t resolution_bits)
+{
+    return static_cast<byte>(((resolution_bits - 9) << 5) | 0x1F);
+}
+
+uint8_t config_to_resolution(byte config)
+{
+    return static_cast<uint8_t>(9 + ((config >> 5) & 0x03));
+}
+
+// the alarm registers are not used; write the factory defaults along with the configuration
+static constexpr byte default_alarm_high {0x4B};
+static constexpr byte default_alarm_low {0x46};
+
 void print_address(Address const &addr)
 {
     for (int i = 0; i < 8; i++)
@@ -31,43 +47,107 @@ void print_address(Address const &addr)
     }
 }
 
+//--------------------------------------------------------------------------------
+// statistics
+
+void ThermistorStatistics::reset(uint64_t new_id)
+{
+    id = new_id;
+    count = 0;
+    sum_raw = 0;
+    sum_squares_raw = 0;
+    min_raw = INT16_MAX;
+    max_raw = INT16_MIN;
+    crc_failures = 0;
+}
+
+void ThermistorStatistics::push(int16_t raw)
+{
+    count += 1;
+    sum_raw += raw;
+    sum_squares_raw += static_cast<int32_t>(raw) * static_cast<int32_t>(raw);
+    if (raw < min_raw)
+    {
+        min_raw = raw;
+    }
+    if (raw > max_raw)
+    {
+        max_raw = raw;
+    }
+}
+
+float ThermistorStatistics::mean_celsius(void) const
+{
+    if (count == 0)
+    {
+        return NAN;
+    }
+    return static_cast<float>(sum_raw) / static_cast<float>(count) / 16.0f;
+}
+
+float ThermistorStatistics::std_celsius(void) const
+{
+    if (count == 0)
+    {
+        return NAN;
+    }
+    // count * sum_squares - sum^2 is exact in integers, and >= 0
+    int64_t const scaled_variance = static_cast<int64_t>(count) * sum_squares_raw - static_cast<int64_t>(sum_raw) * sum_raw;
+    return sqrtf(static_cast<float>(scaled_variance)) / static_cast<float>(count) / 16.0f;
+}
+
 //--------------------------------------------------------------------------------
 // class implementation
 
 void Thermistors_Manager::start(void)
 {
-    SERIAL_USB->println(F("start thermistors"));
+    LOG_PRINTLN(info, F("start thermistors"));
     // give power to the thermistors
     pinMode(PIN_DS18B20_PWR, OUTPUT);
     digitalWrite(PIN_DS18B20_PWR, HIGH);
-    delay(500);
+    power_profiler.peripheral_on(Power_Peripheral::ds18b20);
+    powered = true;
+    sleep_for_milliseconds(500);
 
     // start time
     posix_time_start = board_time_manager.get_posix_timestamp();
 
     // get the list of active thermistors
-    get_ordered_thermistors_ids();
+    update_thermistors_ids();
+
+    // the configuration is lost at each power cut
+    set_resolution(resolution_bits);
 
     // ask for one conversion to start
     request_start_thermistors_conversion();
 
     vector_of_readings.clear();
+
+    vector_of_statistics.clear();
+    ThermistorStatistics crrt_statistics;
+    for (auto &crrt_id : vector_of_ids)
+    {
+        crrt_statistics.reset(crrt_id);
+        vector_of_statistics.push_back(crrt_statistics);
+    }
 }
 
 void Thermistors_Manager::stop(void)
 {
-    SERIAL_USB->println(F("stop thermistors"));
+    LOG_PRINTLN(info, F("stop thermistors"));
     pinMode(PIN_DS18B20_PWR, INPUT);
     pinMode(PIN_DS18B20_DAT, INPUT);
-    delay(100);
+    power_profiler.peripheral_off(Power_Peripheral::ds18b20);
+    powered = false;
+    sleep_for_milliseconds(100);
 }
 
 void Thermistors_Manager::get_ordered_thermistors_ids(void)
 {
-    SERIAL_USB->println(F("get list of ordered thermistors IDs"));
+    LOG_PRINTLN(info, F("get list of ordered thermistors IDs"));
 
     // clear
-    SERIAL_USB->println(F("clear list of thermistors IDs"));
+    LOG_PRINTLN(debug, F("clear list of thermistors IDs"));
     vector_of_ids.clear();
 
     // get all IDs
@@ -81,58 +161,62 @@ void Thermistors_Manager::get_ordered_thermistors_ids(void)
 
         if (!one_wire_thermistors.search(crrt_addr))
         {
-            SERIAL_USB->println("No more addresses.");
+            LOG_PRINTLN(debug, F("No more addresses."));
             one_wire_thermistors.reset_search();
-            delay(250);
+            sleep_for_milliseconds(250);
 
             break;
         }
 
-        SERIAL_USB->println(F("found new address..."));
-        SERIAL_USB->print("ROM =");
-        print_address(crrt_addr);
-        SERIAL_USB->println();
-
         address_to_uint64_t(crrt_addr, crrt_id);
-        SERIAL_USB->print(F("ID = "));
-        print_uint64(crrt_id);
-        SERIAL_USB->println();
+
+        if constexpr (LOG_ENABLED(debug))
+        {
+            SERIAL_USB->println(F("found new address..."));
+            SERIAL_USB->print(F("ROM ="));
+            print_address(crrt_addr);
+            SERIAL_USB->println();
+
+            SERIAL_USB->print(F("ID = "));
+            print_uint64(crrt_id);
+            SERIAL_USB->println();
+        }
 
         if (OneWire::crc8(crrt_addr, 7) != crrt_addr[7])
         {
-            SERIAL_USB->println("WARNING: CRC is not valid!");
+            LOG_PRINTLN(warning, F("WARNING: CRC is not valid!"));
             continue;
         }
         else
         {
-            SERIAL_USB->println(F("CRC is valid"));
+            LOG_PRINTLN(debug, F("CRC is valid"));
         }
 
         // the first ROM byte indicates which chip
         switch (crrt_addr[0])
         {
         case 0x10:
-            SERIAL_USB->println("  WARNING: Chip = DS18S20"); // or old DS1820
+            LOG_PRINTLN(warning, F("  WARNING: Chip = DS18S20")); // or old DS1820
             break;
         case 0x28:
-            SERIAL_USB->println("  CORRECT: Chip = DS18B20");
+            LOG_PRINTLN(debug, F("  CORRECT: Chip = DS18B20"));
             vector_of_ids.push_back(crrt_id);
             pinMode(PIN_STAT_LED, OUTPUT);
             pinMode(PIN_PWR_LED, OUTPUT);
             digitalWrite(PIN_STAT_LED, HIGH);
             digitalWrite(PIN_PWR_LED, HIGH);
-            delay(100);
+            sleep_for_milliseconds(100);
             digitalWrite(PIN_STAT_LED, LOW);
             digitalWrite(PIN_PWR_LED, LOW);
-            delay(300);
+            sleep_for_milliseconds(300);
             pinMode(PIN_STAT_LED, INPUT);
             pinMode(PIN_PWR_LED, INPUT);
             break;
         case 0x22:
-            SERIAL_USB->println("  WARNING: Chip = DS1822");
+            LOG_PRINTLN(warning, F("  WARNING: Chip = DS1822"));
             break;
         default:
-            SERIAL_USB->println("EROR: Device is not a DS18x20 family device.");
+            LOG_PRINTLN(error, F("EROR: Device is not a DS18x20 family device."));
             continue;
         }
     }
@@ -140,21 +224,180 @@ void Thermistors_Manager::get_ordered_thermistors_ids(void)
     return;
 }
 
+void Thermistors_Manager::update_thermistors_ids(void)
+{
+    bool rescan {true};
+
+    if constexpr (thermistors_cache_ids)
+    {
+        if (!ids_scanned || vector_of_ids.empty())
+        {
+            LOG_PRINTLN(info, F("no thermistors IDs cached"));
+        }
+        else if (wakeups_since_ids_scan >= thermistors_rescan_every_n_wakeups)
+        {
+            LOG_PRINTLN(info, F("scheduled rescan of the thermistors IDs"));
+        }
+        else if (!cached_ids_still_answer())
+        {
+            LOG_PRINTLN(warning, F("W a cached thermistor does not answer; rescan"));
+        }
+        else
+        {
+            LOG_PRINT(info, F("reuse the cached thermistors IDs: "));
+            LOG_PRINTLN(info, vector_of_ids.size());
+            rescan = false;
+        }
+    }
+
+    if (rescan)
+    {
+        get_ordered_thermistors_ids();
+        trace_log.record(Trace_Event::thermistors_scan, vector_of_ids.size());
+        ids_scanned = true;
+        wakeups_since_ids_scan = 0;
+    }
+    else
+    {
+        wakeups_since_ids_scan += 1;
+    }
+}
+
+bool Thermistors_Manager::cached_ids_still_answer(void)
+{
+    Address crrt_address;
+    byte data[9];
+
+    for (auto &crrt_id : vector_of_ids)
+    {
+        wdt.restart();
+        uint64_t_to_address(crrt_id, crrt_address);
+
+        if (!one_wire_thermistors.reset())
+        {
+            return false;
+        }
+        one_wire_thermistors.select(crrt_address);
+        one_wire_thermistors.write(0xBE); // Read Scratchpad
+        one_wire_thermistors.read_bytes(data, 9);
+
+        // a missing sensor reads as all 1s, a shorted bus as all 0s; the CRC catches the
+        // former, the reserved bits of the configuration register (always 1) the latter
+        if ((OneWire::crc8(data, 8) != data[8]) || ((data[4] & 0x9F) != 0x1F))
+        {
+            if constexpr (LOG_ENABLED(warning))
+            {
+                print_address(crrt_address);
+                SERIAL_USB->println();
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Thermistors_Manager::set_resolution(uint8_t new_resolution_bits)
+{
+    if ((new_resolution_bits < min_resolution_bits) || (new_resolution_bits > max_resolution_bits))
+    {
+        LOG_PRINTLN(error, F("E invalid thermistors resolution"));
+        return false;
+    }
+
+    resolution_bits = new_resolution_bits;
+    slowest_resolution_bits = new_resolution_bits;
+
+    if (!powered)
+    {
+        return true;
+    }
+
+    // write to all thermistors at once
+    one_wire_thermistors.reset();
+    one_wire_thermistors.skip();
+    one_wire_thermistors.write(0x4E); // Write Scratchpad
+    one_wire_thermistors.write(default_alarm_high);
+    one_wire_thermistors.write(default_alarm_low);
+    one_wire_thermistors.write(resolution_to_config(resolution_bits));
+
+    LOG_PRINT(info, F("thermistors resolution: "));
+    LOG_PRINTLN(info, resolution_bits);
+
+    return true;
+}
+
+bool Thermistors_Manager::write_resolution(uint64_t id, uint8_t new_resolution_bits, bool copy_to_eeprom)
+{
+    if ((new_resolution_bits < min_resolution_bits) || (new_resolution_bits > max_resolution_bits))
+    {
+        LOG_PRINTLN(error, F("E invalid thermistor resolution"));
+        return false;
+    }
+
+    Address crrt_address;
+    uint64_t_to_address(id, crrt_address);
+
+    if (!one_wire_thermistors.reset())
+    {
+        return false;
+    }
+    one_wire_thermistors.select(crrt_address);
+    one_wire_thermistors.write(0x4E); // Write Scratchpad
+    one_wire_thermistors.write(default_alarm_high);
+    one_wire_thermistors.write(default_alarm_low);
+    one_wire_thermistors.write(resolution_to_config(new_resolution_bits));
+
+    if (new_resolution_bits > slowest_resolution_bits)
+    {
+        slowest_resolution_bits = new_resolution_bits;
+    }
+
+    if (copy_to_eeprom)
+    {
+        one_wire_thermistors.reset();
+        one_wire_thermistors.select(crrt_address);
+        one_wire_thermistors.write(0x48); // Copy Scratchpad
+        // the EEPROM write takes up to 10 ms
+        sleep_for_milliseconds(20);
+    }
+
+    return true;
+}
+
+unsigned long Thermistors_Manager::conversion_timeout_ms(void) const
+{
+    return duration_conversion_thermistor_ms >> (max_resolution_bits - slowest_resolution_bits);
+}
+
 void Thermistors_Manager::request_start_thermistors_conversion(void)
 {
     wdt.restart();
 
-    start_last_conversion_ms = millis();
+    start_last_conversion_ms = sleep_aware_millis();
 
     Address crrt_address;
 
+    if constexpr (thermistors_broadcast_conversion)
+    {
+        // ask all sensors at once to start a new measurement
+        LOG_PRINTLN(debug, F("ask to start conversion, broadcast..."));
+        one_wire_thermistors.reset();
+        one_wire_thermistors.skip();
+        one_wire_thermistors.write(0x44);
+        return;
+    }
+
     // ask each sensor to start new measurement
-    SERIAL_USB->println(F("ask to start conversion..."));
+    LOG_PRINTLN(debug, F("ask to start conversion..."));
     for (auto &crrt_id : vector_of_ids)
     {
         uint64_t_to_address(crrt_id, crrt_address);
-        print_address(crrt_address);
-        SERIAL_USB->println();
+        if constexpr (LOG_ENABLED(verbose))
+        {
+            print_address(crrt_address);
+            SERIAL_USB->println();
+        }
 
         one_wire_thermistors.reset();
         one_wire_thermistors.select(crrt_address);
@@ -170,43 +413,47 @@ void Thermistors_Manager::collect_thermistors_conversions(void)
     Address crrt_address;
     byte present = 0;
     byte data[12];
-    float celsius;
     byte crc;
 
     // wait until conversion is ready
-    delay(remaining_conversion_time());
+    wait_for_conversions();
 
     // collect the output of each sensor
-    SERIAL_USB->println(F("collect results..."));
-    for (auto &crrt_id : vector_of_ids)
+    LOG_PRINTLN(debug, F("collect results..."));
+    for (size_t crrt_index = 0; crrt_index < vector_of_ids.size(); crrt_index++)
     {
+        uint64_t const crrt_id = vector_of_ids[crrt_index];
+        ThermistorStatistics &crrt_statistics = vector_of_statistics[crrt_index];
         uint64_t_to_address(crrt_id, crrt_address);
-        print_address(crrt_address);
-        SERIAL_USB->println();
 
         present = one_wire_thermistors.reset();
         one_wire_thermistors.select(crrt_address);
         one_wire_thermistors.write(0xBE); // Read Scratchpad
-
-        SERIAL_USB->print("  Data = ");
-        SERIAL_USB->print(present, HEX);
-        SERIAL_USB->print(" ");
-        for (int i = 0; i < 9; i++)
-        { // we need 9 bytes
-            data[i] = one_wire_thermistors.read();
-            SERIAL_USB->print(data[i], HEX);
-            SERIAL_USB->print(" ");
-        }
-        SERIAL_USB->print(" CRC=");
+        one_wire_thermistors.read_bytes(data, 9); // we need 9 bytes
         crc = OneWire::crc8(data, 8);
-        SERIAL_USB->print(crc, HEX);
-        if (crc != data[8])
+
+        if constexpr (LOG_ENABLED(verbose))
         {
-            SERIAL_USB->println(F(" ERROR: non matching CRC"));
+            print_address(crrt_address);
+            SERIAL_USB->println();
+
+            SERIAL_USB->print(F("  Data = "));
+            SERIAL_USB->print(present, HEX);
+            SERIAL_USB->print(F(" "));
+            for (int i = 0; i < 9; i++)
+            {
+                SERIAL_USB->print(data[i], HEX);
+                SERIAL_USB->print(F(" "));
+            }
+            SERIAL_USB->print(F(" CRC="));
+            SERIAL_USB->println(crc, HEX);
         }
-        else
+
+        if (crc != data[8])
         {
-            SERIAL_USB->println(F(" CRC OK"));
+            LOG_PRINTLN(warning, F("  ERROR: non matching CRC"));
+            trace_log.record(Trace_Event::thermistors_crc_error, crrt_index);
+            crrt_statistics.crc_failures += 1;
         }
 
         // Convert the data to actual temperature
@@ -214,50 +461,56 @@ void Thermistors_Manager::collect_thermistors_conversions(void)
         // be stored to an "int16_t" type, which is always 16 bits
         // even when compiled on a 32 bit processor.
         int16_t raw = (data[1] << 8) | data[0];
-        byte cfg = (data[4] & 0x60);
+        uint8_t const crrt_resolution_bits = config_to_resolution(data[4]);
         // at lower res, the low bits are undefined, so let's zero them
-        if (cfg == 0x00)
-        {
-            raw = raw & ~7;
-            SERIAL_USB->println(F("  WARNING: 9 bit res"));
-        } // 9 bit resolution, 93.75 ms
-        else if (cfg == 0x20)
+        raw = raw & ~((1 << (max_resolution_bits - crrt_resolution_bits)) - 1);
+        if (crrt_resolution_bits != resolution_bits)
         {
-            raw = raw & ~3;
-            SERIAL_USB->println(F("  WARNING: 10 bit res"));
-        } // 10 bit res, 187.5 ms
-        else if (cfg == 0x40)
+            LOG_PRINT(warning, F("  WARNING: resolution bits "));
+            LOG_PRINTLN(warning, crrt_resolution_bits);
+        }
+        // wait long enough for the slowest thermistor at the next conversion
+        if ((crc == data[8]) && (crrt_resolution_bits > slowest_resolution_bits))
         {
-            raw = raw & ~1;
-            SERIAL_USB->println(F("  WARNING: 11 bit res"));
-        } // 11 bit res, 375 ms
-        else if (cfg == 0x60)
+            slowest_resolution_bits = crrt_resolution_bits;
+        }
+
+        if constexpr (LOG_ENABLED(debug))
         {
-            SERIAL_USB->println(F("  OK: 12 bits resolution"));
+            print_sixteenths_to_serial_print_buff(raw);
+            SERIAL_USB->print(F("  Temperature = "));
+            SERIAL_USB->print(serial_print_buff);
+            SERIAL_USB->print(F(" Celsius"));
+            SERIAL_USB->println();
         }
-        else
+
+        if (crc == data[8])
         {
-            SERIAL_USB->println(F("  ERROR: unknown resolution config!"));
+            crrt_statistics.push(raw);
         }
 
-        celsius = (float)raw / 16.0;
-        SERIAL_USB->print("  Temperature = ");
-        SERIAL_USB->print(celsius);
-        SERIAL_USB->print(" Celsius");
-        SERIAL_USB->println();
+        if constexpr (!thermistors_log_raw_readings)
+        {
+            continue;
+        }
 
-        vector_of_readings.push_back(ThermistorReading{crrt_id, celsius});
+        if (vector_of_readings.full())
+        {
+            LOG_PRINTLN(warning, F("  WARNING: vector_of_readings full, reading dropped"));
+            continue;
+        }
+        vector_of_readings.push_back(ThermistorReading{crrt_id, raw});
     }
 }
 
 unsigned long Thermistors_Manager::remaining_conversion_time(void)
 {
-    if (millis() - start_last_conversion_ms < duration_conversion_thermistor_ms)
+    if (sleep_aware_millis() - start_last_conversion_ms < conversion_timeout_ms())
     {
-        unsigned long result = duration_conversion_thermistor_ms - (millis() - start_last_conversion_ms);
-        SERIAL_USB->print(F("conversion not over yet; there are "));
-        SERIAL_USB->print(result);
-        SERIAL_USB->println(F(" ms left"));
+        unsigned long result = conversion_timeout_ms() - (sleep_aware_millis() - start_last_conversion_ms);
+        LOG_PRINT(debug, F("conversion not over yet; there are "));
+        LOG_PRINT(debug, result);
+        LOG_PRINTLN(debug, F(" ms left"));
         return result;
     }
     else
@@ -266,16 +519,55 @@ unsigned long Thermistors_Manager::remaining_conversion_time(void)
     }
 }
 
+void Thermistors_Manager::wait_for_conversions(void)
+{
+    if constexpr (!thermistors_broadcast_conversion)
+    {
+        sleep_for_milliseconds(remaining_conversion_time());
+        return;
+    }
+
+    // the Convert T must be the last command on the bus: an externally powered DS18B20
+    // answers the read slots that follow with 0 while converting, and 1 once done; since
+    // the bus is a wired-AND, a 1 means that all the conversions are over
+    while (one_wire_thermistors.read_bit() == 0)
+    {
+        wdt.restart();
+
+        if (sleep_aware_millis() - start_last_conversion_ms > conversion_timeout_ms())
+        {
+            LOG_PRINTLN(warning, F("WARNING: timeout waiting for the conversions"));
+            trace_log.record(Trace_Event::thermistors_conversion_timeout, sleep_aware_millis() - start_last_conversion_ms);
+            break;
+        }
+
+        sleep_for_milliseconds(thermistors_conversion_poll_interval_ms);
+    }
+
+    trace_log.record(Trace_Event::thermistors_conversion, sleep_aware_millis() - start_last_conversion_ms);
+    LOG_PRINT(debug, F("conversions over after "));
+    LOG_PRINT(debug, sleep_aware_millis() - start_last_conversion_ms);
+    LOG_PRINTLN(debug, F(" ms"));
+}
+
 void Thermistors_Manager::perform_time_acquisition(void)
 {
-    unsigned long time_start_acquisition = millis();
+    unsigned long time_start_acquisition = sleep_aware_millis();
 
     int number_of_readings = 0;
 
-    while (millis() - time_start_acquisition <
+    while (sleep_aware_millis() - time_start_acquisition <
            duration_thermistor_acquisition_ms)
     {
         collect_thermistors_conversions();
+
+        // no room for another round of readings
+        if (thermistors_log_raw_readings && (vector_of_readings.available() < vector_of_ids.size()))
+        {
+            LOG_PRINTLN(warning, F("W vector_of_readings full, stop acquisition early"));
+            break;
+        }
+
         request_start_thermistors_conversion();
     }
 }
@@ -16,9 +16,13 @@ The thermistors are using the 1-wire interface. Data on pin 35, power on pin 4.
 #include "etl/vector.h"
 
 #include "print_utils.h"
+#include "log_utils.h"
 
 #include "watchdog_manager.h"
 #include "time_manager.h"
+#include "power_profiler.h"
+#include "sleep_manager.h"
+#include "trace_log.h"
 
 #include <OneWire.h>
 
@@ -55,9 +59,29 @@ constexpr int number_of_thermistors {10};
 // duration over which sample thermistor data
 constexpr int duration_thermistor_acquisition_ms {6000};
 
+// the readings are kept as the raw DS18B20 value, in 1/16 celsius, all the way to the SD
+// card; this is exact, and avoids the float conversions and printing
 struct ThermistorReading{
     uint64_t id;
-    float reading;
+    int16_t raw;
+};
+
+// streaming statistics of the readings of one thermistor over an acquisition, in integer
+// arithmetic on the raw readings (1/16 celsius counts)
+struct ThermistorStatistics{
+    uint64_t id;
+    uint32_t count;
+    int32_t sum_raw;
+    int64_t sum_squares_raw;
+    int16_t min_raw;
+    int16_t max_raw;
+    uint32_t crc_failures;
+
+    void reset(uint64_t new_id);
+    void push(int16_t raw);
+
+    float mean_celsius(void) const;
+    float std_celsius(void) const;
 };
 
 using Address = byte[8];
@@ -70,6 +94,27 @@ class Thermistors_Manager{
 
         void get_ordered_thermistors_ids(void);
 
+        // reuse the IDs found at a previous wakeup if possible, see thermistors_cache_ids;
+        // run the full search otherwise
+        void update_thermistors_ids(void);
+
+        // true if all the thermistors in vector_of_ids answer with a valid scratchpad
+        bool cached_ids_still_answer(void);
+
+        // the resolution of the whole string, 9 to 12 bits; written to all the thermistors
+        // right away if they are powered, and at each start() (the configuration is lost
+        // when the power is cut); returns false if out of range
+        bool set_resolution(uint8_t resolution_bits);
+
+        // the resolution of a single thermistor, until the next power cut, or permanently
+        // (in the thermistor EEPROM, limited number of write cycles) with copy_to_eeprom;
+        // the thermistors must be powered. Note that start() writes the string resolution
+        // to all the thermistors after the power up, overwriting the EEPROM value
+        bool write_resolution(uint64_t id, uint8_t resolution_bits, bool copy_to_eeprom=false);
+
+        // the longest conversion time of the thermistors, from their resolution, with a margin
+        unsigned long conversion_timeout_ms(void) const;
+
         bool time_to_measure_thermistors(void) const;
 
         void request_start_thermistors_conversion(void);
@@ -80,20 +125,49 @@ class Thermistors_Manager{
         // == 0 the conversions are ready to query
         unsigned long remaining_conversion_time(void);
 
+        // wait until the conversions requested last are over: poll the bus in broadcast
+        // mode, wait for the worst case conversion time otherwise
+        void wait_for_conversions(void);
+
         // perform a time acquisition of temperature; i.e., for each thermistor,
         // sample for several seconds and compute mean and RMS values of the temperature
         void perform_time_acquisition(void);
 
+        static constexpr uint8_t min_resolution_bits {9};
+        static constexpr uint8_t max_resolution_bits {12};
+
+        // worst case conversion time at 12 bits, with a margin; halved for each bit less.
+        // the timeout when polling in broadcast mode
         static constexpr unsigned long duration_conversion_thermistor_ms {1000UL};
-        static constexpr int vector_of_readings_length = number_of_thermistors * duration_thermistor_acquisition_ms / duration_conversion_thermistor_ms;
+        // when polling, a round of readings is over as soon as the slowest thermistor is
+        // done, which is typically a bit under the 750 ms of the datasheet at 12 bits; the
+        // readings vector is sized for the configured resolution, and the acquisition stops
+        // early if it gets full (e.g. if the resolution is lowered at run time)
+        static constexpr unsigned long shortest_round_thermistor_ms {(thermistors_broadcast_conversion ? 500UL : duration_conversion_thermistor_ms) >> (max_resolution_bits - thermistors_resolution_bits)};
+        static constexpr int vector_of_readings_length = thermistors_log_raw_readings ? number_of_thermistors * duration_thermistor_acquisition_ms / shortest_round_thermistor_ms : 0;
 
         etl::vector<uint64_t, number_of_thermistors> vector_of_ids;
+        // only filled with thermistors_log_raw_readings
         etl::vector<ThermistorReading, vector_of_readings_length + 20> vector_of_readings;
+        // one entry per thermistor, in the order of vector_of_ids
+        etl::vector<ThermistorStatistics, number_of_thermistors> vector_of_statistics;
         uint64_t posix_time_start {0};
 
+        // from sleep_aware_millis(), as the waits for the conversions are spent in deep sleep
         unsigned long start_last_conversion_ms;
 
         uint8_t reading_number {0};
+
+        // the resolution written to the whole string at start(), and the highest resolution
+        // on the string since then, that sets the conversion time
+        uint8_t resolution_bits {thermistors_resolution_bits};
+        uint8_t slowest_resolution_bits {max_resolution_bits};
+
+        bool powered {false};
+
+        // state of the IDs cache
+        bool ids_scanned {false};
+        unsigned int wakeups_since_ids_scan {0};
 };
 
 extern OneWire one_wire_thermistors;
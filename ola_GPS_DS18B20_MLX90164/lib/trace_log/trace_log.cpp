@@ -0,0 +1,55 @@
+#include "trace_log.h"
+
+// not zeroed at startup, see the header
+Trace_Log trace_log __attribute__((section(".noinit")));
+
+// "TRCE" when read as ASCII bytes
+static constexpr uint32_t trace_log_magic {0x45435254};
+
+// keep in sync with Trace_Event, and with tools/decode_binary_data.py
+static char const * const trace_event_names[static_cast<size_t>(Trace_Event::number_of_events)] {
+    "boot",
+    "sleep",
+    "wakeup",
+    "gnss_start_failed",
+    "gnss_reboot",
+    "gnss_fix",
+    "gnss_timeout",
+    "thermistors_scan",
+    "thermistors_conversion",
+    "thermistors_conversion_timeout",
+    "thermistors_crc_error",
+    "mlx_start_failed",
+    "mlx_read_failed",
+    "sd_start_failed",
+    "sd_busy_timeout",
+    "sd_write_error",
+    "sd_block_written",
+    "gnss_assistance",
+    "mlx_hardware_i2c_fallback",
+    "heap_allocation",
+    "sd_block_too_large",
+};
+
+void Trace_Log::start(uint16_t crrt_boot_number){
+    // after a power cycle, the SRAM content is random
+    if ((magic != trace_log_magic) || (head >= number_of_records) || (count > number_of_records)){
+        clear();
+    }
+
+    boot_number = crrt_boot_number;
+    record(Trace_Event::boot, crrt_boot_number);
+}
+
+void Trace_Log::clear(void){
+    magic = trace_log_magic;
+    head = 0;
+    count = 0;
+}
+
+char const * Trace_Log::get_event_name(uint16_t event){
+    if (event >= static_cast<uint16_t>(Trace_Event::number_of_events)){
+        return "unknown";
+    }
+    return trace_event_names[event];
+}
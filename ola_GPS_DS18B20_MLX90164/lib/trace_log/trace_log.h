@@ -0,0 +1,116 @@
+#ifndef TRACE_LOG_H
+#define TRACE_LOG_H
+
+#include "Arduino.h"
+
+#include "user_configuration.h"
+
+#include "time_manager.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// a post mortem trace of the last events, that survives a watchdog reset
+//
+// the serial output is usually not connected in the field, so when the watchdog reboots
+// the board (e.g. the while(true){} in SD_Manager::start_card), nothing tells what
+// happened before. The trace is a ring buffer of small binary records, kept in the
+// .noinit section (NOLOAD, see linker_scripts/artemis_svl_noinit.ld): the startup code
+// does not clear it, and the SRAM is retained during deep sleep and through a watchdog
+// reset. At boot, start() checks the ring buffer header and keeps the records if it is
+// valid (i.e. after a reset), or starts over if not (i.e. after a power cycle, that leaves
+// random content). SD_Manager::log_boot writes the records to the SD card, and clears the
+// trace once written.
+//
+// recording an event is a few stores and no function call; it is fine to use in the hot
+// loops. It is not interrupt safe: only record from the main program, not from an ISR.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// the events; keep in sync with the names in trace_log.cpp, and with
+// tools/decode_binary_data.py. Only add at the end, so that the old logs still decode.
+// the meaning of the argument is given for each event
+enum class Trace_Event : uint16_t {
+    boot = 0,                            // boot number
+    sleep,                               // number of seconds to sleep
+    wakeup,                              // 0
+    gnss_start_failed,                   // attempt number
+    gnss_reboot,                         // 0; the watchdog reboots the board
+    gnss_fix,                            // number of satellites
+    gnss_timeout,                        // timeout, in seconds
+    thermistors_scan,                    // number of DS18B20 found
+    thermistors_conversion,              // conversion duration, in ms
+    thermistors_conversion_timeout,      // conversion duration, in ms
+    thermistors_crc_error,               // index of the thermistor
+    mlx_start_failed,                    // attempt number
+    mlx_read_failed,                     // 0
+    sd_start_failed,                     // 0; the watchdog reboots the board
+    sd_busy_timeout,                     // 0
+    sd_write_error,                      // 0: sector write, 1: file close (then reboot)
+    sd_block_written,                    // number of sectors
+    gnss_assistance,                     // number of navigation database bytes pushed
+    mlx_hardware_i2c_fallback,           // attempt number; the MLX is read with SoftWire
+    heap_allocation,                     // number of heap allocations in a guarded path
+    sd_block_too_large,                  // padded block length; written to its own file
+    number_of_events
+};
+
+struct Trace_Record {
+    uint32_t posix_timestamp;  // the RTC seconds counter, see time_manager.h
+    uint16_t boot_number;      // the lower 16 bits of the boot number
+    uint16_t event;            // a Trace_Event
+    uint32_t arg;
+};
+
+static_assert(sizeof(Trace_Record) == 12, "unexpected Trace_Record size");
+
+class Trace_Log{
+    public:
+        static constexpr uint32_t number_of_records {trace_log_number_of_records};
+
+        // call once at boot, as early as possible, with the new boot number; keep the
+        // records of the previous boots if they survived, and record a boot event
+        void start(uint16_t crrt_boot_number);
+
+        void record(Trace_Event event, uint32_t arg = 0){
+            if constexpr (!trace_log_enabled){
+                return;
+            }
+
+            Trace_Record & crrt_record = records[head];
+            // a single 32 bits load on the Artemis, so no need to mask the RTC interrupt
+            crrt_record.posix_timestamp = static_cast<uint32_t>(posix_timestamp);
+            crrt_record.boot_number = boot_number;
+            crrt_record.event = static_cast<uint16_t>(event);
+            crrt_record.arg = arg;
+
+            head = (head + 1) & (number_of_records - 1);
+            if (count < number_of_records){
+                count += 1;
+            }
+        }
+
+        uint32_t size(void) const { return count; }
+
+        // the records, from the oldest (index 0) to the latest (index size() - 1)
+        Trace_Record const & get_record(uint32_t index) const {
+            return records[(head + number_of_records - count + index) & (number_of_records - 1)];
+        }
+
+        // drop all the records; call once they are safely on the SD card
+        void clear(void);
+
+        // a short name for each event, used in the ASCII log; the host side decoder uses
+        // the same names
+        static char const * get_event_name(uint16_t event);
+
+    private:
+        // no default member initializers: the object lives in .noinit, and must not be
+        // touched by the startup code
+        uint32_t magic;
+        uint32_t head;
+        uint32_t count;
+        uint16_t boot_number;
+        Trace_Record records[number_of_records];
+};
+
+extern Trace_Log trace_log;
+
+#endif
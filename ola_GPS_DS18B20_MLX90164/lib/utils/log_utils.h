@@ -0,0 +1,36 @@
+#ifndef LOG_UTILS_H
+#define LOG_UTILS_H
+
+#include "Arduino.h"
+
+#include "firmware_configuration.h"
+#include "user_configuration.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// leveled serial logging, filtered at compile time
+//
+// the level of a message is one of the Log_Level, without the prefix: error, warning,
+// info, debug, verbose. The messages above serial_log_level (see user_configuration.h) are
+// in a discarded if constexpr branch: the arguments are not evaluated, and no code is
+// generated for them.
+//
+// LOG_PRINT(debug, F("ID = "));
+// LOG_PRINTLN(debug, crrt_id);
+//
+// when a message needs more than a print (e.g. calling one of the print_utils helpers),
+// put the whole block behind the same test:
+//
+// if constexpr (LOG_ENABLED(verbose)){
+//     print_hex_u8s(data, 9);
+// }
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define LOG_ENABLED(level) (static_cast<int>(Log_Level::level) <= static_cast<int>(serial_log_level))
+
+#define LOG_PRINT(level, ...) do { if constexpr (LOG_ENABLED(level)) { SERIAL_USB->print(__VA_ARGS__); } } while (0)
+#define LOG_PRINTLN(level, ...) do { if constexpr (LOG_ENABLED(level)) { SERIAL_USB->println(__VA_ARGS__); } } while (0)
+
+// the PRINTLN_VAR of print_utils.h, at a given level
+#define LOG_PRINTLN_VAR(level, v) do { if constexpr (LOG_ENABLED(level)) { PRINTLN_VAR(v) } } while (0)
+
+#endif
@@ -67,6 +67,25 @@ void print_uint64_to_serial_print_buff(uint64_t to_print){
     }
 }
 
+void print_sixteenths_to_serial_print_buff(int16_t to_print){
+    int32_t const absolute_value = (to_print < 0) ? -static_cast<int32_t>(to_print) : static_cast<int32_t>(to_print);
+    // 1/16 is 0.0625, so the fractional part is a whole number of 1/10000
+    snprintf(serial_print_buff, serial_print_max_buffer, "%s%ld.%04ld",
+             (to_print < 0) ? "-" : "",
+             static_cast<long>(absolute_value / 16),
+             static_cast<long>((absolute_value % 16) * 625));
+}
+
+void print_fiftieths_kelvin_as_celsius_to_serial_print_buff(int16_t to_print){
+    // 1/50 K is 2/100 K, and 0 celsius is 27315/100 K
+    int32_t const hundredths_celsius = 2 * static_cast<int32_t>(to_print) - 27315;
+    int32_t const absolute_value = (hundredths_celsius < 0) ? -hundredths_celsius : hundredths_celsius;
+    snprintf(serial_print_buff, serial_print_max_buffer, "%s%ld.%02ld",
+             (hundredths_celsius < 0) ? "-" : "",
+             static_cast<long>(absolute_value / 100),
+             static_cast<long>(absolute_value % 100));
+}
+
 // for the print_hex family of functins:
 // 1 byte is represented by 2 hex chars
 // so u8 ie 1 byte is 0x + 1*2 + 1 hex chars ie 5 chars
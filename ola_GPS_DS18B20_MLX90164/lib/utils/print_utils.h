@@ -26,6 +26,14 @@
 
 void print_uint64_to_serial_print_buff(uint64_t to_print);
 
+// print a fixed point value in 1/16 units (e.g. a DS18B20 raw reading, in 1/16 celsius) as
+// a decimal number with 4 decimals; this is exact, and does not use any float
+void print_sixteenths_to_serial_print_buff(int16_t to_print);
+
+// print a temperature in 1/50 kelvin (e.g. a MLX90614 raw reading) as celsius with 2
+// decimals; this is exact, and does not use any float
+void print_fiftieths_kelvin_as_celsius_to_serial_print_buff(int16_t to_print);
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // various print functions
 // we print to SERIAL_USB
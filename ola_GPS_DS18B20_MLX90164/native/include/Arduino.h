@@ -0,0 +1,189 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// host (native) stand-in for the parts of the Apollo3 Arduino core used by the firmware
+//
+// only what the firmware actually uses is provided; the behavior is as close as
+// reasonably possible to the Apollo3 core, so that the firmware code runs unmodified.
+// time is simulated, see native_simulation.h
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "am_hal_simulation.h"
+#include "native_simulation.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+//--------------------------------------------------------------------------------
+// constants
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PI 3.1415926535897932384626433832795
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+//--------------------------------------------------------------------------------
+// flash strings: on the host, a flash string is a normal string
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+//--------------------------------------------------------------------------------
+// time; these advance the simulated clock instead of waiting
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+
+//--------------------------------------------------------------------------------
+// interrupts
+
+void noInterrupts(void);
+void interrupts(void);
+
+//--------------------------------------------------------------------------------
+// gpio and adc; the pin levels are kept in a table, an input reads as pulled up
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogReadResolution(int bits);
+
+//--------------------------------------------------------------------------------
+// String, only the subset used by the firmware and the libraries
+
+class String {
+    public:
+        String(const char * content = "");
+        String(const String & other);
+        explicit String(char c);
+        explicit String(int value, unsigned char base = DEC);
+        explicit String(unsigned int value, unsigned char base = DEC);
+        explicit String(long value, unsigned char base = DEC);
+        explicit String(unsigned long value, unsigned char base = DEC);
+        explicit String(float value, unsigned char decimal_places = 2);
+        explicit String(double value, unsigned char decimal_places = 2);
+        ~String();
+
+        String & operator=(const String & other);
+        String & operator+=(const String & other);
+        String & operator+=(const char * other);
+
+        const char * c_str(void) const { return buffer; }
+        unsigned int length(void) const { return static_cast<unsigned int>(strlen(buffer)); }
+
+        friend String operator+(const String & lhs, const String & rhs);
+        friend String operator+(const char * lhs, const String & rhs);
+        friend String operator+(const String & lhs, const char * rhs);
+
+    private:
+        void assign(const char * content);
+        char * buffer;
+};
+
+//--------------------------------------------------------------------------------
+// Print and Stream
+
+class Print {
+    public:
+        virtual ~Print() {}
+
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t * buffer, size_t size);
+        size_t write(const char * str) { return str == nullptr ? 0 : write(reinterpret_cast<const uint8_t *>(str), strlen(str)); }
+        size_t write(const char * buffer, size_t size) { return write(reinterpret_cast<const uint8_t *>(buffer), size); }
+
+        virtual void flush(void) {}
+
+        size_t print(const __FlashStringHelper * str);
+        size_t print(const String & str);
+        size_t print(const char str[]);
+        size_t print(char c);
+        size_t print(unsigned char value, int base = DEC);
+        size_t print(int value, int base = DEC);
+        size_t print(unsigned int value, int base = DEC);
+        size_t print(long value, int base = DEC);
+        size_t print(unsigned long value, int base = DEC);
+        size_t print(long long value, int base = DEC);
+        size_t print(unsigned long long value, int base = DEC);
+        size_t print(double value, int digits = 2);
+
+        size_t println(const __FlashStringHelper * str);
+        size_t println(const String & str);
+        size_t println(const char str[]);
+        size_t println(char c);
+        size_t println(unsigned char value, int base = DEC);
+        size_t println(int value, int base = DEC);
+        size_t println(unsigned int value, int base = DEC);
+        size_t println(long value, int base = DEC);
+        size_t println(unsigned long value, int base = DEC);
+        size_t println(long long value, int base = DEC);
+        size_t println(unsigned long long value, int base = DEC);
+        size_t println(double value, int digits = 2);
+        size_t println(void);
+
+        int getWriteError(void) { return write_error; }
+        void clearWriteError(void) { setWriteError(0); }
+
+    protected:
+        void setWriteError(int error = 1) { write_error = error; }
+
+    private:
+        size_t print_number(unsigned long long value, int base);
+        int write_error {0};
+};
+
+class Stream : public Print {
+    public:
+        virtual int available(void) = 0;
+        virtual int read(void) = 0;
+        virtual int peek(void) = 0;
+};
+
+//--------------------------------------------------------------------------------
+// the USB serial; everything printed goes to the host stdout
+
+class Uart : public Stream {
+    public:
+        void begin(unsigned long baudrate);
+        void end(void);
+        operator bool() const { return true; }
+
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t * buffer, size_t size) override;
+        using Print::write;
+        void flush(void) override;
+
+        int available(void) override { return 0; }
+        int read(void) override { return -1; }
+        int peek(void) override { return -1; }
+};
+
+extern Uart Serial;
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef NATIVE_EEPROM_H
+#define NATIVE_EEPROM_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// host (native) stand-in for the Apollo3 core EEPROM emulation
+// the content is loaded from / saved to the host file sim_config.eeprom_file, so that it
+// survives between runs, as the boot counter does on the board
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Arduino.h"
+
+class EEPROMClass {
+    public:
+        static constexpr size_t eeprom_size {1024};
+
+        uint8_t read(int address);
+        void write(int address, uint8_t value);
+        size_t length(void) const { return eeprom_size; }
+
+        template <typename T>
+        T & get(int address, T & value){
+            load();
+            memcpy(&value, &content[address], sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        const T & put(int address, const T & value){
+            load();
+            memcpy(&content[address], &value, sizeof(T));
+            save();
+            return value;
+        }
+
+    private:
+        void load(void);
+        void save(void);
+
+        bool loaded {false};
+        uint8_t content[eeprom_size];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
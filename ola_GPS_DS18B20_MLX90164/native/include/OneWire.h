@@ -0,0 +1,42 @@
+#ifndef NATIVE_ONEWIRE_H
+#define NATIVE_ONEWIRE_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// host (native) stand-in for the OneWire library, with simulated DS18B20 sensors on the bus
+//
+// the sensors are simulated at the level of the 1-wire commands (ROM commands and DS18B20
+// function commands), not of the individual time slots. Each transferred byte or bit
+// advances the simulated clock by the duration of the corresponding time slots, so that
+// the bus usage of the firmware shows in the timings.
+// the number of sensors is sim_config.number_of_ds18b20; each one reads a slowly varying
+// temperature with a bit of noise, at the configured resolution.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Arduino.h"
+
+class OneWire {
+    public:
+        explicit OneWire(uint8_t pin);
+
+        uint8_t reset(void);
+        void select(const uint8_t rom[8]);
+        void skip(void);
+        void write(uint8_t value, uint8_t power = 0);
+        void write_bytes(const uint8_t * buffer, uint16_t count, bool power = 0);
+        uint8_t read(void);
+        void read_bytes(uint8_t * buffer, uint16_t count);
+        void write_bit(uint8_t value);
+        uint8_t read_bit(void);
+        void depower(void);
+
+        void reset_search(void);
+        bool search(uint8_t * new_address, bool search_mode = true);
+
+        static uint8_t crc8(const uint8_t * address, uint8_t length);
+
+    private:
+        uint8_t pin;
+        size_t search_index {0};
+};
+
+#endif
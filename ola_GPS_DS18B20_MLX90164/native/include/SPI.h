@@ -0,0 +1,7 @@
+#ifndef NATIVE_SPI_H
+#define NATIVE_SPI_H
+
+// host (native) stand-in: the SPI bus is only used through the simulated SdFat
+#include "Arduino.h"
+
+#endif
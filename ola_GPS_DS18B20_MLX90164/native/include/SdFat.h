@@ -0,0 +1,98 @@
+#ifndef NATIVE_SDFAT_H
+#define NATIVE_SDFAT_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// host (native) stand-in for the SdFat v2 library, backed by files in a host folder
+//
+// the files are written to sim_config.sd_card_directory, with the same names as on the SD
+// card, so that the output of a simulated run can be inspected / decoded as usual.
+// the cost of the SD card operations is simulated at the sector level, following what
+// SdFat does: one sector cache for the partial sector writes (read, modify, write back
+// when another sector is needed or at flush), and direct transfer of the whole aligned
+// sectors. Each sector read / write advances the simulated clock by the configured
+// duration; the card is never reported busy since the write durations are accounted for
+// when writing.
+// preAllocate follows the FAT32 convention: the file size becomes the preallocated size.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+
+#include "Arduino.h"
+#include "SPI.h"
+
+typedef int oflag_t;
+
+#ifndef O_AT_END
+#define O_AT_END 0x40000000
+#endif
+
+#define DEDICATED_SPI 1
+#define SHARED_SPI 0
+#define SD_SCK_MHZ(maxMhz) (1000000UL * (maxMhz))
+
+class SdSpiConfig {
+    public:
+        SdSpiConfig(uint8_t cs, uint8_t opt, uint32_t max_sck) : cs_pin{cs}, options{opt}, max_sck{max_sck} {}
+
+        uint8_t cs_pin;
+        uint8_t options;
+        uint32_t max_sck;
+};
+
+class SdCard {
+    public:
+        bool isBusy(void) { return false; }
+};
+
+class SdFs {
+    public:
+        bool begin(SdSpiConfig config);
+        void end(void);
+        bool exists(const char * path);
+        bool remove(const char * path);
+        SdCard * card(void) { return &sd_card; }
+
+    private:
+        SdCard sd_card;
+};
+
+class FsFile : public Print {
+    public:
+        ~FsFile();
+
+        bool open(const char * path, oflag_t oflag = O_RDONLY);
+        bool close(void);
+        bool isOpen(void) const { return host_file != nullptr; }
+
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t * buffer, size_t size) override;
+        size_t write(const void * buffer, size_t size) { return write(static_cast<const uint8_t *>(buffer), size); }
+        using Print::write;
+
+        int read(void * buffer, size_t size);
+        int read(void);
+
+        bool seekSet(uint64_t position);
+        uint64_t curPosition(void) const { return position; }
+        uint64_t fileSize(void) const { return file_size; }
+        bool preAllocate(uint64_t length);
+
+        void flush(void) override;
+        bool sync(void);
+
+    private:
+        // simulated cost of accessing the sectors in [position, position + size)
+        void access_sectors(uint64_t start, size_t size, bool writing);
+        void flush_cache(void);
+
+        FILE * host_file {nullptr};
+        uint64_t position {0};
+        uint64_t file_size {0};
+
+        static constexpr uint64_t no_sector {UINT64_MAX};
+        uint64_t cached_sector {no_sector};
+        bool cache_dirty {false};
+        bool directory_entry_dirty {false};
+};
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef NATIVE_SPARKFUN_UBLOX_GNSS_H
+#define NATIVE_SPARKFUN_UBLOX_GNSS_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// host (native) stand-in for the SparkFun u-blox GNSS library, with a simulated receiver
+//
+// the receiver is powered through the Qwiic power pin, as on the logger PCB; it answers
+// on the I2C port once powered, and gets a 3D fix sim_config.gnss_time_to_fix_ms after
+// being powered. The time is the simulated clock, starting at sim_config.gnss_start_posix.
+// as in the real library, the getters poll a fresh UBX-NAV-PVT message (taking the
+// simulated I2C transfer time) when the field asked for has already been read since the
+// last poll.
+// with the periodic ("auto") NAV-PVT enabled by setAutoPVTcallbackPtr, the receiver has a
+// new NAV-PVT at each navigation epoch (setMeasurementRate); checkUblox() reads it (taking
+// the simulated I2C transfer time) and checkCallbacks() hands it to the callback.
+// once the receiver navigated, readNavigationDatabase() dumps a simulated UBX-MGA-DBD
+// database; when the UTC time and a database less than 4 hours old are pushed back after
+// a power cycle, the receiver hot starts (sim_config.gnss_hot_time_to_fix_ms).
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Arduino.h"
+#include "Wire.h"
+
+#define COM_TYPE_UBX  (1 << 0)
+#define COM_TYPE_NMEA (1 << 1)
+
+enum dynModel {
+    DYN_MODEL_PORTABLE = 0,
+    DYN_MODEL_STATIONARY = 2,
+    DYN_MODEL_PEDESTRIAN,
+    DYN_MODEL_AUTOMOTIVE,
+    DYN_MODEL_SEA,
+};
+
+static constexpr uint16_t defaultMaxWait {1100};
+static constexpr uint16_t defaultMGAdelay {7};  // ms between the MGA messages pushed without ack
+static constexpr uint16_t defaultNavDBDMaxWait {3100};
+
+typedef enum {
+    SFE_UBLOX_MGA_ASSIST_ACK_NO,
+    SFE_UBLOX_MGA_ASSIST_ACK_YES,
+    SFE_UBLOX_MGA_ASSIST_ACK_ENQUIRE,
+} sfe_ublox_mga_assist_ack_e;
+
+// the subset of the UBX-NAV-PVT payload used by the firmware, with the library names
+struct UBX_NAV_PVT_data_t {
+    uint32_t iTOW;     // GPS time of week of the navigation epoch, ms
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t min;
+    uint8_t sec;
+    int32_t nano;      // fraction of second, ns
+    uint8_t fixType;
+    uint8_t numSV;
+    int32_t lon;       // 1e-7 deg
+    int32_t lat;       // 1e-7 deg
+    int32_t hMSL;      // mm
+    int32_t gSpeed;    // mm/s
+    int32_t headMot;   // 1e-5 deg
+    uint16_t pDOP;     // 0.01
+};
+
+class SFE_UBLOX_GNSS {
+    public:
+        bool begin(TwoWire & wire_port, uint8_t device_address = 0x42, uint16_t max_wait = defaultMaxWait, bool assume_success = false);
+
+        bool setI2COutput(uint8_t com_settings, uint16_t max_wait = defaultMaxWait);
+        bool setDynamicModel(dynModel new_dynamic_model = DYN_MODEL_PORTABLE, uint16_t max_wait = defaultMaxWait);
+        bool setMeasurementRate(uint16_t rate, uint16_t max_wait = defaultMaxWait);
+
+        // periodic NAV-PVT messages, handed to the callback by checkCallbacks()
+        bool setAutoPVTcallbackPtr(void (*callback_pointer)(UBX_NAV_PVT_data_t *), uint16_t max_wait = defaultMaxWait);
+        bool checkUblox(void);
+        void checkCallbacks(void);
+
+        // assistance (MGA-INI-TIME_UTC, MGA-INI-POS_LLH, MGA-DBD)
+        bool setUTCTimeAssistance(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second,
+                                  uint32_t nanos = 0, uint16_t tAccS = 0, uint32_t tAccNs = 0, uint8_t source = 0,
+                                  sfe_ublox_mga_assist_ack_e mgaAck = SFE_UBLOX_MGA_ASSIST_ACK_NO, uint16_t maxWait = defaultMGAdelay);
+        bool setPositionAssistanceLLH(int32_t lat, int32_t lon, int32_t alt, uint32_t posAcc,
+                                      sfe_ublox_mga_assist_ack_e mgaAck = SFE_UBLOX_MGA_ASSIST_ACK_NO, uint16_t maxWait = defaultMGAdelay);
+        size_t pushAssistNowData(const uint8_t * dataBytes, size_t numDataBytes,
+                                 sfe_ublox_mga_assist_ack_e mgaAck = SFE_UBLOX_MGA_ASSIST_ACK_NO, uint16_t maxWait = defaultMGAdelay);
+        size_t readNavigationDatabase(uint8_t * dataBytes, size_t maxNumDataBytes, uint16_t maxWait = defaultNavDBDMaxWait);
+
+        uint8_t getFixType(uint16_t max_wait = defaultMaxWait);
+        uint16_t getMillisecond(uint16_t max_wait = defaultMaxWait);
+        uint8_t getSecond(uint16_t max_wait = defaultMaxWait);
+        uint8_t getMinute(uint16_t max_wait = defaultMaxWait);
+        uint8_t getHour(uint16_t max_wait = defaultMaxWait);
+        uint8_t getDay(uint16_t max_wait = defaultMaxWait);
+        uint8_t getMonth(uint16_t max_wait = defaultMaxWait);
+        uint16_t getYear(uint16_t max_wait = defaultMaxWait);
+        int32_t getLatitude(uint16_t max_wait = defaultMaxWait);
+        int32_t getLongitude(uint16_t max_wait = defaultMaxWait);
+        int32_t getAltitudeMSL(uint16_t max_wait = defaultMaxWait);
+        int32_t getGroundSpeed(uint16_t max_wait = defaultMaxWait);
+        uint8_t getSIV(uint16_t max_wait = defaultMaxWait);
+        int32_t getHeading(uint16_t max_wait = defaultMaxWait);
+        uint16_t getPDOP(uint16_t max_wait = defaultMaxWait);
+
+    private:
+        enum PVT_Field : uint32_t {
+            field_fix_type = 1 << 0,
+            field_millisecond = 1 << 1,
+            field_second = 1 << 2,
+            field_minute = 1 << 3,
+            field_hour = 1 << 4,
+            field_day = 1 << 5,
+            field_month = 1 << 6,
+            field_year = 1 << 7,
+            field_latitude = 1 << 8,
+            field_longitude = 1 << 9,
+            field_altitude_msl = 1 << 10,
+            field_ground_speed = 1 << 11,
+            field_siv = 1 << 12,
+            field_heading = 1 << 13,
+            field_pdop = 1 << 14,
+        };
+
+        struct PVT_Data {
+            uint8_t fix_type;
+            uint16_t millisecond;
+            uint8_t second;
+            uint8_t minute;
+            uint8_t hour;
+            uint8_t day;
+            uint8_t month;
+            uint16_t year;
+            int32_t latitude;
+            int32_t longitude;
+            int32_t altitude_msl;
+            int32_t ground_speed;
+            uint8_t siv;
+            int32_t heading;
+            uint16_t pdop;
+        };
+
+        bool receiver_answers(void) const;
+        // the time from power up to the first fix, cold or hot start
+        uint64_t time_to_fix_us(void) const;
+        // poll a new UBX-NAV-PVT if the field was already read since the last poll
+        void refresh_if_stale(uint32_t field);
+        void poll_pvt(void);
+        // the navigation solution of the simulated receiver, at the current time
+        void compute_pvt(void);
+
+        TwoWire * i2c_port {nullptr};
+        uint32_t fresh_fields {0};
+        PVT_Data pvt {};
+
+        uint64_t measurement_period_us {1000000ULL};
+        void (*auto_pvt_callback)(UBX_NAV_PVT_data_t *) {nullptr};
+        uint64_t next_auto_pvt_us {0};
+        bool auto_pvt_callback_pending {false};
+        UBX_NAV_PVT_data_t auto_pvt_data {};
+
+        // assistance received since the last power up; the database carries the simulated
+        // time at which it was dumped
+        bool time_assisted {false};
+        bool database_assisted {false};
+        uint64_t database_pushed_us {0};
+        uint64_t database_dumped_us {0};
+};
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef NATIVE_STREAM_H
+#define NATIVE_STREAM_H
+
+// host (native) stand-in: Print and Stream are declared together in Arduino.h
+#include "Arduino.h"
+
+#endif
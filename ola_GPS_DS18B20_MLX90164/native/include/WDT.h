@@ -0,0 +1,24 @@
+#ifndef NATIVE_WDT_H
+#define NATIVE_WDT_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// host (native) stand-in for the Apollo3 core watchdog library
+// the firmware uses while(true){} to get rebooted by the watchdog; on the host, the
+// watchdog is a timer on the host clock, that ends the program if it is not restarted
+// for sim_config.wdt_host_timeout_s seconds
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Arduino.h"
+
+#define WDT_16HZ 1
+#define WDT_1HZ 2
+
+class APM3_WDT {
+    public:
+        void configure(uint8_t clock, uint32_t interrupt, uint32_t reset);
+        void start(void);
+        void stop(void);
+        void restart(void);
+};
+
+#endif
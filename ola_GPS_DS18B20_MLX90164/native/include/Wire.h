@@ -0,0 +1,27 @@
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// host (native) stand-in for the Apollo3 core hardware I2C ports
+// the devices on the bus are simulated at the library level (see the u-blox stand-in), so
+// the port only keeps track of being started or not
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Arduino.h"
+
+class TwoWire {
+    public:
+        void begin(void) { started = true; }
+        void end(void) { started = false; }
+        void setClock(uint32_t frequency) { clock_frequency = frequency; }
+        bool is_started(void) const { return started; }
+
+    private:
+        bool started {false};
+        uint32_t clock_frequency {100000};
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
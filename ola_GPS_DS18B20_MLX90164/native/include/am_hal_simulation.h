@@ -0,0 +1,235 @@
+#ifndef AM_HAL_SIMULATION_H
+#define AM_HAL_SIMULATION_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// host (native) stand-in for the subset of the Ambiq Apollo3 HAL / BSP used by the firmware
+//
+// the calls that only configure power domains, pads and clocks are no-ops; the ones that
+// matter for the behavior of the firmware are simulated:
+//   - the RTC alarm interrupt, calling am_rtc_isr every simulated second once enabled
+//   - the CTIMER compare interrupts (one shot and repeat functions), calling am_ctimer_isr
+//   - freezing the system timer, that stops millis() and micros()
+//   - deep sleep, that fast forwards the simulated clock to the next interrupt
+//   - the IOM I2C transfers, that find no device on the bus
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+
+#define AM_HAL_STATUS_SUCCESS 0
+#define AM_HAL_STATUS_FAIL    1
+
+//--------------------------------------------------------------------------------
+// interrupts
+
+typedef enum {
+    RTC_IRQn = 2,
+    CTIMER_IRQn = 14,
+} IRQn_Type;
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+
+void am_hal_interrupt_master_enable(void);
+
+//--------------------------------------------------------------------------------
+// mcu control
+
+#define AM_HAL_MCUCTRL_INFO_DEVICEID 1
+
+typedef struct {
+    uint32_t ui32ChipPN;
+    uint32_t ui32ChipID0;
+    uint32_t ui32ChipID1;
+    uint32_t ui32ChipRev;
+} am_hal_mcuctrl_device_t;
+
+uint32_t am_hal_mcuctrl_info_get(uint32_t info_type, void * info);
+
+//--------------------------------------------------------------------------------
+// clocks and RTC
+
+#define AM_HAL_CLKGEN_CONTROL_XTAL_START 1
+#define AM_HAL_CLKGEN_CONTROL_SYSCLK_MAX 2
+
+#define AM_HAL_RTC_OSC_XT 1
+#define AM_HAL_RTC_ALM_RPT_SEC 6
+#define AM_HAL_RTC_INT_ALM 0x00000008
+
+uint32_t am_hal_clkgen_control(uint32_t control, void * args);
+void am_hal_rtc_osc_select(uint32_t oscillator);
+void am_hal_rtc_osc_enable(void);
+void am_hal_rtc_alarm_interval_set(uint32_t repeat_interval);
+void am_hal_rtc_int_clear(uint32_t interrupt_mask);
+void am_hal_rtc_int_enable(uint32_t interrupt_mask);
+
+// defined in the firmware (time_manager.cpp); called by the simulated RTC
+extern "C" void am_rtc_isr(void) __attribute__((weak));
+
+//--------------------------------------------------------------------------------
+// system timer
+
+#define AM_HAL_STIMER_CFG_CLEAR  0x00000001
+#define AM_HAL_STIMER_CFG_FREEZE 0x00000002
+#define AM_HAL_STIMER_HFRC_3MHZ  0x00000100
+#define AM_HAL_STIMER_XTAL_32KHZ 0x00000300
+
+// returns the previous configuration, as the HAL does
+uint32_t am_hal_stimer_config(uint32_t config);
+
+//--------------------------------------------------------------------------------
+// counter / timers; only the compare 0 interrupt of each segment is simulated
+
+#define AM_HAL_CTIMER_TIMERA 0x0000FFFF
+#define AM_HAL_CTIMER_TIMERB 0xFFFF0000
+#define AM_HAL_CTIMER_BOTH   0xFFFFFFFF
+
+#define AM_HAL_CTIMER_HFRC_12MHZ    (0x1 << 1)
+#define AM_HAL_CTIMER_HFRC_3MHZ     (0x2 << 1)
+#define AM_HAL_CTIMER_XT_32_768KHZ  (0x6 << 1)
+#define AM_HAL_CTIMER_CLOCK_MASK    (0x1F << 1)
+
+#define AM_HAL_CTIMER_FN_ONCE   (0x0 << 6)
+#define AM_HAL_CTIMER_FN_REPEAT (0x1 << 6)
+#define AM_HAL_CTIMER_FN_MASK   (0x7 << 6)
+
+#define AM_HAL_CTIMER_INT_ENABLE (0x1 << 9)
+
+// timer n segment A is bit 2 n, segment B is bit 2 n + 1
+#define AM_HAL_CTIMER_INT_TIMERA0 0x00000001
+#define AM_HAL_CTIMER_INT_TIMERB0 0x00000002
+#define AM_HAL_CTIMER_INT_TIMERA1 0x00000004
+#define AM_HAL_CTIMER_INT_TIMERB1 0x00000008
+#define AM_HAL_CTIMER_INT_TIMERA2 0x00000010
+#define AM_HAL_CTIMER_INT_TIMERB2 0x00000020
+#define AM_HAL_CTIMER_INT_TIMERA3 0x00000040
+#define AM_HAL_CTIMER_INT_TIMERB3 0x00000080
+
+void am_hal_ctimer_config_single(uint32_t timer_number, uint32_t timer_segment, uint32_t config);
+void am_hal_ctimer_start(uint32_t timer_number, uint32_t timer_segment);
+void am_hal_ctimer_stop(uint32_t timer_number, uint32_t timer_segment);
+void am_hal_ctimer_clear(uint32_t timer_number, uint32_t timer_segment);
+uint32_t am_hal_ctimer_read(uint32_t timer_number, uint32_t timer_segment);
+void am_hal_ctimer_period_set(uint32_t timer_number, uint32_t timer_segment, uint32_t period, uint32_t on_time);
+void am_hal_ctimer_compare_set(uint32_t timer_number, uint32_t timer_segment, uint32_t compare_register, uint32_t value);
+
+void am_hal_ctimer_int_enable(uint32_t interrupt_mask);
+void am_hal_ctimer_int_disable(uint32_t interrupt_mask);
+void am_hal_ctimer_int_clear(uint32_t interrupt_mask);
+uint32_t am_hal_ctimer_int_status_get(bool enabled_only);
+
+// defined in the firmware if used; called by the simulated CTIMER
+extern "C" void am_ctimer_isr(void) __attribute__((weak));
+
+//--------------------------------------------------------------------------------
+// power control, pads, adc
+
+#define AM_HAL_PWRCTRL_MEM_ALL       0x1
+#define AM_HAL_PWRCTRL_MEM_MAX       0x2
+#define AM_HAL_PWRCTRL_MEM_SRAM_384K 0x3
+
+uint32_t am_hal_pwrctrl_memory_deepsleep_powerdown(uint32_t memory);
+uint32_t am_hal_pwrctrl_memory_deepsleep_retain(uint32_t memory);
+
+// the HAL packs the fields in a 32 bits bitfield; only the ones set by the firmware here
+typedef struct {
+    uint32_t configuration;
+    uint32_t uFuncSel;
+    uint32_t ePullup;
+    uint32_t eDriveStrength;
+    uint32_t eGPOutcfg;
+    uint32_t eGPInput;
+    uint32_t uIOMnum;
+} am_hal_gpio_pincfg_t;
+
+#define AM_HAL_PIN_8_M1SCL     1
+#define AM_HAL_PIN_9_M1SDAWIR3 1
+
+#define AM_HAL_GPIO_PIN_PULLUP_WEAK         1
+#define AM_HAL_GPIO_PIN_PULLUP_1_5K         3
+#define AM_HAL_GPIO_PIN_DRIVESTRENGTH_12MA  2
+#define AM_HAL_GPIO_PIN_OUTCFG_DISABLE      0
+#define AM_HAL_GPIO_PIN_OUTCFG_OPENDRAIN    2
+#define AM_HAL_GPIO_PIN_INPUT_ENABLE        1
+
+extern const am_hal_gpio_pincfg_t g_AM_HAL_GPIO_DISABLE;
+extern const am_hal_gpio_pincfg_t g_AM_BSP_GPIO_COM_UART_TX;
+extern const am_hal_gpio_pincfg_t g_AM_BSP_GPIO_COM_UART_RX;
+extern const am_hal_gpio_pincfg_t g_AM_BSP_GPIO_SWDCK;
+extern const am_hal_gpio_pincfg_t g_AM_BSP_GPIO_SWDIO;
+
+// a GPIO function (3) pad with an output is an OUTPUT of the simulated gpio, any other
+// configuration an INPUT (see Arduino.h)
+uint32_t am_hal_gpio_pinconfig(uint32_t pin, am_hal_gpio_pincfg_t config);
+
+// register access macros in the HAL; on the simulated gpio
+void am_hal_gpio_output_set(uint32_t pin);
+void am_hal_gpio_output_clear(uint32_t pin);
+uint32_t am_hal_gpio_input_read(uint32_t pin);
+
+void power_adc_disable(void);
+void ap3_adc_setup(void);
+
+//--------------------------------------------------------------------------------
+// IOM (hardware I2C / SPI masters)
+
+#define AM_HAL_IOM_100KHZ 100000
+#define AM_HAL_IOM_400KHZ 400000
+
+#define AM_HAL_IOM_ERR_I2C_NAK 0x08000001
+
+#define AM_HAL_SYSCTRL_WAKE        0
+#define AM_HAL_SYSCTRL_NORMALSLEEP 1
+#define AM_HAL_SYSCTRL_DEEPSLEEP   2
+
+typedef enum {
+    AM_HAL_IOM_SPI_MODE,
+    AM_HAL_IOM_I2C_MODE,
+} am_hal_iom_mode_e;
+
+typedef enum {
+    AM_HAL_IOM_TX,
+    AM_HAL_IOM_RX,
+} am_hal_iom_dir_e;
+
+typedef struct {
+    am_hal_iom_mode_e eInterfaceMode;
+    uint32_t ui32ClockFreq;
+    uint32_t * pNBTxnBuf;
+    uint32_t ui32NBTxnBufLength;
+} am_hal_iom_config_t;
+
+typedef struct {
+    union {
+        uint32_t ui32SpiChipSelect;
+        uint32_t ui32I2CDevAddr;
+    } uPeerInfo;
+    uint32_t ui32InstrLen;
+    uint32_t ui32Instr;
+    uint32_t ui32NumBytes;
+    am_hal_iom_dir_e eDirection;
+    uint32_t * pui32TxBuffer;
+    uint32_t * pui32RxBuffer;
+    bool bContinue;
+    uint8_t ui8RepeatCount;
+    uint16_t ui16PauseCondition;
+    uint16_t ui16StatusSetClr;
+    uint8_t ui8Priority;
+} am_hal_iom_transfer_t;
+
+uint32_t am_hal_iom_initialize(uint32_t module, void ** handle);
+uint32_t am_hal_iom_uninitialize(void * handle);
+uint32_t am_hal_iom_power_ctrl(void * handle, uint32_t power_state, bool retain_state);
+uint32_t am_hal_iom_configure(void * handle, am_hal_iom_config_t * config);
+uint32_t am_hal_iom_enable(void * handle);
+uint32_t am_hal_iom_disable(void * handle);
+uint32_t am_hal_iom_blocking_transfer(void * handle, am_hal_iom_transfer_t * transfer);
+
+//--------------------------------------------------------------------------------
+// sleep
+
+#define AM_HAL_SYSCTRL_SLEEP_DEEP   true
+#define AM_HAL_SYSCTRL_SLEEP_NORMAL false
+
+void am_hal_sysctrl_sleep(bool deep_sleep);
+
+#endif
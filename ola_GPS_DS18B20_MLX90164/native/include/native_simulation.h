@@ -0,0 +1,96 @@
+#ifndef NATIVE_SIMULATION_H
+#define NATIVE_SIMULATION_H
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// the core of the host (native) simulation: simulated clock, configuration, counters
+//
+// the simulated time is the host time elapsed since the start of the program, plus the
+// time that the firmware "spends" in delay(), delayMicroseconds(), deep sleep, and
+// simulated peripheral operations (SD card writes, 1-wire transfers, etc). These are not
+// actually waited for on the host, so that a full deployment day runs in a few seconds,
+// while the CPU time spent in the firmware code itself is still real and measurable.
+//
+// the simulation is configured with environment variables, see native/README.md
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct Native_Simulation_Config {
+    unsigned long number_of_loops;      // OLA_NATIVE_LOOPS, number of loop() calls before exiting
+    char sd_card_directory[256];        // OLA_NATIVE_SD_DIR, host folder standing in for the SD card
+    char eeprom_file[256];              // OLA_NATIVE_EEPROM, host file standing in for the EEPROM
+    uint64_t gnss_start_posix;          // OLA_NATIVE_START_POSIX, the UTC time at the start of the simulation
+    unsigned long gnss_time_to_fix_ms;  // OLA_NATIVE_GNSS_TTFF_MS, time from GNSS power on to fix
+    unsigned long gnss_hot_time_to_fix_ms;  // OLA_NATIVE_GNSS_HOT_TTFF_MS, same, with time and a fresh database pushed
+    size_t number_of_ds18b20;           // OLA_NATIVE_DS18B20, number of sensors on the 1-wire bus
+    unsigned long sd_sector_write_us;   // OLA_NATIVE_SD_WRITE_US, simulated cost of writing one sector
+    unsigned long sd_sector_read_us;    // OLA_NATIVE_SD_READ_US, simulated cost of reading one sector
+    unsigned long wdt_host_timeout_s;   // OLA_NATIVE_WDT_S, host seconds without wdt.restart() before "reboot"
+    bool quiet;                         // OLA_NATIVE_QUIET, drop the serial output
+};
+
+struct Native_Simulation_Counters {
+    uint64_t micros_in_delay;
+    uint64_t micros_in_deep_sleep;
+    uint64_t micros_in_peripherals;
+    uint64_t serial_bytes;
+    uint64_t sd_sectors_written;
+    uint64_t sd_sectors_read;
+    uint64_t sd_bytes_written;
+    uint64_t sd_files_opened;
+    uint64_t onewire_bytes;
+    uint64_t rtc_interrupts;
+    uint64_t ctimer_interrupts;
+};
+
+extern Native_Simulation_Config sim_config;
+extern Native_Simulation_Counters sim_counters;
+
+// read the configuration from the environment; called once by the native main
+void sim_init(void);
+
+// print the counters and timings to stderr
+void sim_print_summary(void);
+
+// current simulated time, in microseconds since the start of the program
+uint64_t sim_micros(void);
+
+// the system timer behind millis() / micros(): the simulated time, minus the time it was
+// frozen (AM_HAL_STIMER_CFG_FREEZE); its clock source and rate are not simulated
+uint64_t sim_stimer_micros(void);
+void sim_stimer_freeze(bool freeze);
+
+// advance the simulated clock (the host does not wait), firing the interrupts that
+// become due on the way; the counter tells what the time was spent on
+void sim_advance_micros(uint64_t duration_us, uint64_t & counter);
+
+// fire the interrupts that are due at the current simulated time, if interrupts are enabled
+void sim_service_interrupts(void);
+
+// deep sleep: jump to the next interrupt, and fire it
+void sim_deep_sleep_until_next_interrupt(void);
+
+// the RTC alarm interrupt, enabled by the firmware through the HAL
+void sim_enable_rtc_interrupt(bool enable);
+
+// the CTIMER interrupt, enabled by the firmware through the HAL; the HAL stand-in tells
+// when the next timer reaches its compare value (0: none), and sim_ctimer_expired
+// (am_hal_simulation.cpp) is called at that time
+void sim_enable_ctimer_interrupt(bool enable);
+void sim_schedule_ctimer_event(uint64_t due_us);
+void sim_ctimer_expired(uint64_t due_us);
+
+// the pin levels, shared between the Arduino gpio functions and the simulated peripherals;
+// a pin powering a peripheral is high when set as an output at HIGH
+bool sim_pin_is_high(uint8_t pin);
+// simulated time at which the pin last went high
+uint64_t sim_pin_high_since_us(uint8_t pin);
+
+// called by wdt.restart(); the host watchdog "reboots" (exits) if this is not called
+// for sim_config.wdt_host_timeout_s host seconds
+void sim_watchdog_kick(void);
+void sim_watchdog_enable(bool enable);
+void sim_watchdog_set_timeout(uint64_t timeout_us);
+
+#endif
@@ -0,0 +1,344 @@
+#include "Arduino.h"
+
+//--------------------------------------------------------------------------------
+// interrupts
+
+void NVIC_EnableIRQ(IRQn_Type irq){
+    if (irq == RTC_IRQn){
+        sim_enable_rtc_interrupt(true);
+    }
+    if (irq == CTIMER_IRQn){
+        sim_enable_ctimer_interrupt(true);
+    }
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq){
+    if (irq == RTC_IRQn){
+        sim_enable_rtc_interrupt(false);
+    }
+    if (irq == CTIMER_IRQn){
+        sim_enable_ctimer_interrupt(false);
+    }
+}
+
+void am_hal_interrupt_master_enable(void){
+    interrupts();
+}
+
+//--------------------------------------------------------------------------------
+// mcu control
+
+uint32_t am_hal_mcuctrl_info_get(uint32_t info_type, void * info){
+    if (info_type == AM_HAL_MCUCTRL_INFO_DEVICEID){
+        am_hal_mcuctrl_device_t * device = static_cast<am_hal_mcuctrl_device_t *>(info);
+        device->ui32ChipPN = 0x06000000;
+        // a fixed, recognizable, chip ID for the host
+        device->ui32ChipID0 = 0x484F5354;
+        device->ui32ChipID1 = 0x00000001;
+        device->ui32ChipRev = 0x21;
+    }
+    return 0;
+}
+
+//--------------------------------------------------------------------------------
+// clocks and RTC; the RTC interrupt is only delivered once enabled in the NVIC
+
+uint32_t am_hal_clkgen_control(uint32_t control, void * args){
+    (void)control;
+    (void)args;
+    return 0;
+}
+
+void am_hal_rtc_osc_select(uint32_t oscillator){ (void)oscillator; }
+void am_hal_rtc_osc_enable(void){}
+void am_hal_rtc_alarm_interval_set(uint32_t repeat_interval){ (void)repeat_interval; }
+void am_hal_rtc_int_clear(uint32_t interrupt_mask){ (void)interrupt_mask; }
+void am_hal_rtc_int_enable(uint32_t interrupt_mask){ (void)interrupt_mask; }
+
+static uint32_t stimer_configuration {AM_HAL_STIMER_HFRC_3MHZ};
+
+uint32_t am_hal_stimer_config(uint32_t config){
+    uint32_t const previous_configuration = stimer_configuration;
+    stimer_configuration = config;
+    sim_stimer_freeze((config & AM_HAL_STIMER_CFG_FREEZE) != 0);
+    return previous_configuration;
+}
+
+//--------------------------------------------------------------------------------
+// counter / timers: each segment counts from 0 to its compare 0 value, then fires its
+// interrupt, and either stops (one shot) or starts again from 0 (repeat)
+
+static constexpr uint32_t number_of_ctimers {8};
+static constexpr uint32_t number_of_segments {2 * number_of_ctimers};
+
+struct Simulated_Ctimer_Segment {
+    uint32_t config;
+    uint32_t compare_0;
+    bool running;
+    uint64_t started_us;
+};
+
+static Simulated_Ctimer_Segment ctimer_segments[number_of_segments];
+static uint32_t ctimer_interrupt_status {0};
+static uint32_t ctimer_interrupt_enabled {0};
+
+// the segments designated by a HAL timer number and segment mask, as a bit mask of indices
+// in ctimer_segments
+static uint32_t selected_segments(uint32_t timer_number, uint32_t timer_segment){
+    if (timer_number >= number_of_ctimers){
+        return 0;
+    }
+    uint32_t selection {0};
+    if (timer_segment & AM_HAL_CTIMER_TIMERA){
+        selection |= 1UL << (2 * timer_number);
+    }
+    if (timer_segment & AM_HAL_CTIMER_TIMERB){
+        selection |= 1UL << (2 * timer_number + 1);
+    }
+    return selection;
+}
+
+static uint64_t ctimer_tick_rate_hz(uint32_t config){
+    switch (config & AM_HAL_CTIMER_CLOCK_MASK){
+        case AM_HAL_CTIMER_HFRC_12MHZ:
+            return 12000000ULL;
+        case AM_HAL_CTIMER_HFRC_3MHZ:
+            return 3000000ULL;
+        case AM_HAL_CTIMER_XT_32_768KHZ:
+            return 32768ULL;
+        default:
+            return 0;
+    }
+}
+
+static uint64_t ctimer_expiry_us(Simulated_Ctimer_Segment const & segment){
+    uint64_t const rate_hz = ctimer_tick_rate_hz(segment.config);
+    if (!segment.running || rate_hz == 0 || segment.compare_0 == 0){
+        return 0;
+    }
+    // round up: the compare value is reached at the end of the last tick
+    return segment.started_us + (1000000ULL * segment.compare_0 + rate_hz - 1) / rate_hz;
+}
+
+// tell the simulation core about the next segment to reach its compare value
+static void schedule_next_ctimer_event(void){
+    uint64_t next_us {0};
+    for (uint32_t ind=0; ind<number_of_segments; ind++){
+        uint64_t const expiry_us = ctimer_expiry_us(ctimer_segments[ind]);
+        if (expiry_us != 0 && (next_us == 0 || expiry_us < next_us)){
+            next_us = expiry_us;
+        }
+    }
+    sim_schedule_ctimer_event(next_us);
+}
+
+void sim_ctimer_expired(uint64_t due_us){
+    for (uint32_t ind=0; ind<number_of_segments; ind++){
+        Simulated_Ctimer_Segment & segment = ctimer_segments[ind];
+        uint64_t const expiry_us = ctimer_expiry_us(segment);
+        if (expiry_us == 0 || expiry_us > due_us){
+            continue;
+        }
+
+        if ((segment.config & AM_HAL_CTIMER_INT_ENABLE) != 0){
+            ctimer_interrupt_status |= (1UL << ind);
+        }
+
+        if ((segment.config & AM_HAL_CTIMER_FN_MASK) == AM_HAL_CTIMER_FN_REPEAT){
+            segment.started_us = expiry_us;
+        }
+        else {
+            segment.running = false;
+        }
+    }
+
+    schedule_next_ctimer_event();
+
+    if ((ctimer_interrupt_status & ctimer_interrupt_enabled) != 0 && am_ctimer_isr){
+        am_ctimer_isr();
+    }
+}
+
+void am_hal_ctimer_config_single(uint32_t timer_number, uint32_t timer_segment, uint32_t config){
+    uint32_t const selection = selected_segments(timer_number, timer_segment);
+    for (uint32_t ind=0; ind<number_of_segments; ind++){
+        if (selection & (1UL << ind)){
+            ctimer_segments[ind].config = config;
+            ctimer_segments[ind].running = false;
+        }
+    }
+    schedule_next_ctimer_event();
+}
+
+void am_hal_ctimer_start(uint32_t timer_number, uint32_t timer_segment){
+    uint32_t const selection = selected_segments(timer_number, timer_segment);
+    for (uint32_t ind=0; ind<number_of_segments; ind++){
+        if ((selection & (1UL << ind)) && !ctimer_segments[ind].running){
+            ctimer_segments[ind].running = true;
+            ctimer_segments[ind].started_us = sim_micros();
+        }
+    }
+    schedule_next_ctimer_event();
+}
+
+void am_hal_ctimer_stop(uint32_t timer_number, uint32_t timer_segment){
+    uint32_t const selection = selected_segments(timer_number, timer_segment);
+    for (uint32_t ind=0; ind<number_of_segments; ind++){
+        if (selection & (1UL << ind)){
+            ctimer_segments[ind].running = false;
+        }
+    }
+    schedule_next_ctimer_event();
+}
+
+void am_hal_ctimer_clear(uint32_t timer_number, uint32_t timer_segment){
+    // clearing also stops the segment; it counts from 0 when started again
+    am_hal_ctimer_stop(timer_number, timer_segment);
+}
+
+uint32_t am_hal_ctimer_read(uint32_t timer_number, uint32_t timer_segment){
+    if (timer_number >= number_of_ctimers){
+        return 0;
+    }
+    uint32_t const segment_index = 2 * timer_number + ((timer_segment == AM_HAL_CTIMER_TIMERB) ? 1 : 0);
+    Simulated_Ctimer_Segment const & segment = ctimer_segments[segment_index];
+    if (!segment.running){
+        return 0;
+    }
+    return static_cast<uint32_t>((sim_micros() - segment.started_us) * ctimer_tick_rate_hz(segment.config) / 1000000ULL);
+}
+
+void am_hal_ctimer_period_set(uint32_t timer_number, uint32_t timer_segment, uint32_t period, uint32_t on_time){
+    (void)on_time;
+    am_hal_ctimer_compare_set(timer_number, timer_segment, 0, period);
+}
+
+void am_hal_ctimer_compare_set(uint32_t timer_number, uint32_t timer_segment, uint32_t compare_register, uint32_t value){
+    if (compare_register != 0){
+        return;
+    }
+    uint32_t const selection = selected_segments(timer_number, timer_segment);
+    for (uint32_t ind=0; ind<number_of_segments; ind++){
+        if (selection & (1UL << ind)){
+            ctimer_segments[ind].compare_0 = value;
+        }
+    }
+    schedule_next_ctimer_event();
+}
+
+void am_hal_ctimer_int_enable(uint32_t interrupt_mask){
+    ctimer_interrupt_enabled |= interrupt_mask;
+}
+
+void am_hal_ctimer_int_disable(uint32_t interrupt_mask){
+    ctimer_interrupt_enabled &= ~interrupt_mask;
+}
+
+void am_hal_ctimer_int_clear(uint32_t interrupt_mask){
+    ctimer_interrupt_status &= ~interrupt_mask;
+}
+
+uint32_t am_hal_ctimer_int_status_get(bool enabled_only){
+    return enabled_only ? (ctimer_interrupt_status & ctimer_interrupt_enabled) : ctimer_interrupt_status;
+}
+
+//--------------------------------------------------------------------------------
+// power control, pads, adc: nothing to do on the host
+
+uint32_t am_hal_pwrctrl_memory_deepsleep_powerdown(uint32_t memory){
+    (void)memory;
+    return 0;
+}
+
+uint32_t am_hal_pwrctrl_memory_deepsleep_retain(uint32_t memory){
+    (void)memory;
+    return 0;
+}
+
+const am_hal_gpio_pincfg_t g_AM_HAL_GPIO_DISABLE {0};
+const am_hal_gpio_pincfg_t g_AM_BSP_GPIO_COM_UART_TX {1};
+const am_hal_gpio_pincfg_t g_AM_BSP_GPIO_COM_UART_RX {2};
+const am_hal_gpio_pincfg_t g_AM_BSP_GPIO_SWDCK {3};
+const am_hal_gpio_pincfg_t g_AM_BSP_GPIO_SWDIO {4};
+
+uint32_t am_hal_gpio_pinconfig(uint32_t pin, am_hal_gpio_pincfg_t config){
+    bool const is_gpio_output = (config.uFuncSel == 3) && (config.eGPOutcfg != AM_HAL_GPIO_PIN_OUTCFG_DISABLE);
+    pinMode(pin, is_gpio_output ? OUTPUT : INPUT);
+    return 0;
+}
+
+// nothing else drives the lines on the host: an open drain output reads what it writes
+void am_hal_gpio_output_set(uint32_t pin){
+    digitalWrite(pin, HIGH);
+}
+
+void am_hal_gpio_output_clear(uint32_t pin){
+    digitalWrite(pin, LOW);
+}
+
+uint32_t am_hal_gpio_input_read(uint32_t pin){
+    return digitalRead(pin);
+}
+
+void power_adc_disable(void){}
+void ap3_adc_setup(void){}
+
+//--------------------------------------------------------------------------------
+// IOM: the modules can be taken and released as on the MCU, the I2C bus is empty
+
+static constexpr uint32_t number_of_iom_modules {6};
+static bool iom_module_taken[number_of_iom_modules] {};
+
+uint32_t am_hal_iom_initialize(uint32_t module, void ** handle){
+    if ((module >= number_of_iom_modules) || iom_module_taken[module]){
+        return AM_HAL_STATUS_FAIL;
+    }
+    iom_module_taken[module] = true;
+    *handle = &iom_module_taken[module];
+    return AM_HAL_STATUS_SUCCESS;
+}
+
+uint32_t am_hal_iom_uninitialize(void * handle){
+    *static_cast<bool *>(handle) = false;
+    return AM_HAL_STATUS_SUCCESS;
+}
+
+uint32_t am_hal_iom_power_ctrl(void * handle, uint32_t power_state, bool retain_state){
+    (void)handle;
+    (void)power_state;
+    (void)retain_state;
+    return AM_HAL_STATUS_SUCCESS;
+}
+
+uint32_t am_hal_iom_configure(void * handle, am_hal_iom_config_t * config){
+    (void)handle;
+    (void)config;
+    return AM_HAL_STATUS_SUCCESS;
+}
+
+uint32_t am_hal_iom_enable(void * handle){
+    (void)handle;
+    return AM_HAL_STATUS_SUCCESS;
+}
+
+uint32_t am_hal_iom_disable(void * handle){
+    (void)handle;
+    return AM_HAL_STATUS_SUCCESS;
+}
+
+// the address byte goes out and is not acknowledged
+uint32_t am_hal_iom_blocking_transfer(void * handle, am_hal_iom_transfer_t * transfer){
+    (void)handle;
+    (void)transfer;
+    sim_advance_micros(100, sim_counters.micros_in_peripherals); // START, address, NAK, STOP at 100 kHz
+    return AM_HAL_IOM_ERR_I2C_NAK;
+}
+
+//--------------------------------------------------------------------------------
+// sleep
+
+// normal and deep sleep only differ by power consumption, not timings
+void am_hal_sysctrl_sleep(bool deep_sleep){
+    (void)deep_sleep;
+    sim_deep_sleep_until_next_interrupt();
+}
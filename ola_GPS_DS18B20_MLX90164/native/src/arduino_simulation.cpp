@@ -0,0 +1,308 @@
+#include "Arduino.h"
+
+//--------------------------------------------------------------------------------
+// time
+
+unsigned long millis(void){
+    sim_service_interrupts();
+    return static_cast<unsigned long>(sim_stimer_micros() / 1000ULL);
+}
+
+unsigned long micros(void){
+    sim_service_interrupts();
+    return static_cast<unsigned long>(sim_stimer_micros());
+}
+
+void delay(unsigned long ms){
+    sim_advance_micros(1000ULL * ms, sim_counters.micros_in_delay);
+}
+
+void delayMicroseconds(unsigned int us){
+    sim_advance_micros(us, sim_counters.micros_in_delay);
+}
+
+void yield(void){
+    sim_service_interrupts();
+}
+
+//--------------------------------------------------------------------------------
+// gpio and adc
+
+static constexpr size_t number_of_pins {64};
+
+struct Simulated_Pin {
+    uint8_t mode;
+    uint8_t level;
+    uint64_t high_since_us;
+};
+
+static Simulated_Pin simulated_pins[number_of_pins] {};
+
+void pinMode(uint8_t pin, uint8_t mode){
+    if (pin >= number_of_pins){
+        return;
+    }
+    bool const was_high = sim_pin_is_high(pin);
+    simulated_pins[pin].mode = mode;
+    if (!was_high && sim_pin_is_high(pin)){
+        simulated_pins[pin].high_since_us = sim_micros();
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value){
+    if (pin >= number_of_pins){
+        return;
+    }
+    bool const was_high = sim_pin_is_high(pin);
+    simulated_pins[pin].level = (value == LOW) ? LOW : HIGH;
+    if (!was_high && sim_pin_is_high(pin)){
+        simulated_pins[pin].high_since_us = sim_micros();
+    }
+}
+
+int digitalRead(uint8_t pin){
+    if (pin >= number_of_pins){
+        return LOW;
+    }
+    // nothing drives the lines on the host: an input reads the pull up
+    if (simulated_pins[pin].mode == OUTPUT){
+        return simulated_pins[pin].level;
+    }
+    return HIGH;
+}
+
+bool sim_pin_is_high(uint8_t pin){
+    return (pin < number_of_pins) && (simulated_pins[pin].mode == OUTPUT) && (simulated_pins[pin].level == HIGH);
+}
+
+uint64_t sim_pin_high_since_us(uint8_t pin){
+    return (pin < number_of_pins) ? simulated_pins[pin].high_since_us : 0;
+}
+
+int analogRead(uint8_t pin){
+    (void)pin;
+    // about 5V on the Vin/3 divider, at 14 bits resolution
+    return 9580;
+}
+
+void analogReadResolution(int bits){
+    (void)bits;
+}
+
+//--------------------------------------------------------------------------------
+// String
+
+static char * duplicate_string(const char * content){
+    size_t const length = strlen(content);
+    char * result = static_cast<char *>(malloc(length + 1));
+    memcpy(result, content, length + 1);
+    return result;
+}
+
+static void unsigned_to_chars(unsigned long long value, unsigned char base, char * buffer, size_t size){
+    char digits[72];
+    size_t crrt_index {0};
+    do {
+        unsigned const digit = static_cast<unsigned>(value % base);
+        digits[crrt_index++] = static_cast<char>(digit < 10 ? '0' + digit : 'A' + digit - 10);
+        value /= base;
+    } while (value != 0 && crrt_index < sizeof(digits));
+
+    size_t out_index {0};
+    while (crrt_index > 0 && out_index + 1 < size){
+        buffer[out_index++] = digits[--crrt_index];
+    }
+    buffer[out_index] = '\0';
+}
+
+static void signed_to_chars(long long value, unsigned char base, char * buffer, size_t size){
+    if (value < 0 && base == DEC){
+        buffer[0] = '-';
+        unsigned_to_chars(static_cast<unsigned long long>(-(value + 1)) + 1, base, buffer + 1, size - 1);
+    }
+    else {
+        unsigned_to_chars(static_cast<unsigned long long>(value), base, buffer, size);
+    }
+}
+
+String::String(const char * content) : buffer{duplicate_string(content == nullptr ? "" : content)} {}
+
+String::String(const String & other) : buffer{duplicate_string(other.buffer)} {}
+
+String::String(char c) : buffer{nullptr} {
+    char content[2] {c, '\0'};
+    buffer = duplicate_string(content);
+}
+
+String::String(int value, unsigned char base) : String(static_cast<long>(value), base) {}
+
+String::String(unsigned int value, unsigned char base) : String(static_cast<unsigned long>(value), base) {}
+
+String::String(long value, unsigned char base) : buffer{nullptr} {
+    char content[72];
+    signed_to_chars(value, base, content, sizeof(content));
+    buffer = duplicate_string(content);
+}
+
+String::String(unsigned long value, unsigned char base) : buffer{nullptr} {
+    char content[72];
+    unsigned_to_chars(value, base, content, sizeof(content));
+    buffer = duplicate_string(content);
+}
+
+String::String(float value, unsigned char decimal_places) : String(static_cast<double>(value), decimal_places) {}
+
+String::String(double value, unsigned char decimal_places) : buffer{nullptr} {
+    char content[72];
+    snprintf(content, sizeof(content), "%.*f", decimal_places, value);
+    buffer = duplicate_string(content);
+}
+
+String::~String(){
+    free(buffer);
+}
+
+void String::assign(const char * content){
+    char * new_buffer = duplicate_string(content);
+    free(buffer);
+    buffer = new_buffer;
+}
+
+String & String::operator=(const String & other){
+    if (this != &other){
+        assign(other.buffer);
+    }
+    return *this;
+}
+
+String & String::operator+=(const char * other){
+    size_t const length = strlen(buffer);
+    size_t const other_length = strlen(other);
+    char * new_buffer = static_cast<char *>(malloc(length + other_length + 1));
+    memcpy(new_buffer, buffer, length);
+    memcpy(new_buffer + length, other, other_length + 1);
+    free(buffer);
+    buffer = new_buffer;
+    return *this;
+}
+
+String & String::operator+=(const String & other){
+    return (*this += other.buffer);
+}
+
+String operator+(const String & lhs, const String & rhs){
+    String result {lhs};
+    result += rhs;
+    return result;
+}
+
+String operator+(const char * lhs, const String & rhs){
+    String result {lhs};
+    result += rhs;
+    return result;
+}
+
+String operator+(const String & lhs, const char * rhs){
+    String result {lhs};
+    result += rhs;
+    return result;
+}
+
+//--------------------------------------------------------------------------------
+// Print
+
+size_t Print::write(const uint8_t * buffer, size_t size){
+    size_t written {0};
+    while (size--){
+        if (write(*buffer++)){
+            written++;
+        }
+        else {
+            break;
+        }
+    }
+    return written;
+}
+
+size_t Print::print_number(unsigned long long value, int base){
+    char content[72];
+    unsigned_to_chars(value, static_cast<unsigned char>(base < 2 ? DEC : base), content, sizeof(content));
+    return write(content);
+}
+
+size_t Print::print(const __FlashStringHelper * str){ return write(reinterpret_cast<const char *>(str)); }
+size_t Print::print(const String & str){ return write(str.c_str()); }
+size_t Print::print(const char str[]){ return write(str); }
+size_t Print::print(char c){ return write(static_cast<uint8_t>(c)); }
+size_t Print::print(unsigned char value, int base){ return print(static_cast<unsigned long long>(value), base); }
+size_t Print::print(int value, int base){ return print(static_cast<long long>(value), base); }
+size_t Print::print(unsigned int value, int base){ return print(static_cast<unsigned long long>(value), base); }
+size_t Print::print(long value, int base){ return print(static_cast<long long>(value), base); }
+size_t Print::print(unsigned long value, int base){ return print(static_cast<unsigned long long>(value), base); }
+
+size_t Print::print(long long value, int base){
+    if (base == DEC && value < 0){
+        size_t const written = print('-');
+        return written + print_number(static_cast<unsigned long long>(-(value + 1)) + 1, base);
+    }
+    if (base == DEC){
+        return print_number(static_cast<unsigned long long>(value), base);
+    }
+    // as the Arduino core: negative numbers in other bases print as 32 bits two's complement
+    return print_number(static_cast<unsigned long long>(static_cast<uint32_t>(value)), base);
+}
+
+size_t Print::print(unsigned long long value, int base){ return print_number(value, base); }
+
+size_t Print::print(double value, int digits){
+    if (isnan(value)) return print("nan");
+    if (isinf(value)) return print("inf");
+    if (value > 4294967040.0 || value < -4294967040.0) return print("ovf");
+
+    char content[72];
+    snprintf(content, sizeof(content), "%.*f", digits, value);
+    return write(content);
+}
+
+size_t Print::println(void){ return write("\r\n"); }
+size_t Print::println(const __FlashStringHelper * str){ return print(str) + println(); }
+size_t Print::println(const String & str){ return print(str) + println(); }
+size_t Print::println(const char str[]){ return print(str) + println(); }
+size_t Print::println(char c){ return print(c) + println(); }
+size_t Print::println(unsigned char value, int base){ return print(value, base) + println(); }
+size_t Print::println(int value, int base){ return print(value, base) + println(); }
+size_t Print::println(unsigned int value, int base){ return print(value, base) + println(); }
+size_t Print::println(long value, int base){ return print(value, base) + println(); }
+size_t Print::println(unsigned long value, int base){ return print(value, base) + println(); }
+size_t Print::println(long long value, int base){ return print(value, base) + println(); }
+size_t Print::println(unsigned long long value, int base){ return print(value, base) + println(); }
+size_t Print::println(double value, int digits){ return print(value, digits) + println(); }
+
+//--------------------------------------------------------------------------------
+// the USB serial
+
+Uart Serial;
+
+void Uart::begin(unsigned long baudrate){
+    (void)baudrate;
+}
+
+void Uart::end(void){
+    fflush(stdout);
+}
+
+size_t Uart::write(uint8_t c){
+    return write(&c, 1);
+}
+
+size_t Uart::write(const uint8_t * buffer, size_t size){
+    sim_counters.serial_bytes += size;
+    if (!sim_config.quiet){
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+void Uart::flush(void){
+    fflush(stdout);
+}
@@ -0,0 +1,40 @@
+#include "EEPROM.h"
+
+EEPROMClass EEPROM;
+
+void EEPROMClass::load(void){
+    if (loaded){
+        return;
+    }
+
+    // an erased flash reads as 0xFF
+    memset(content, 0xFF, eeprom_size);
+
+    FILE * eeprom_file = fopen(sim_config.eeprom_file, "rb");
+    if (eeprom_file != nullptr){
+        size_t const ignored = fread(content, 1, eeprom_size, eeprom_file);
+        (void)ignored;
+        fclose(eeprom_file);
+    }
+
+    loaded = true;
+}
+
+void EEPROMClass::save(void){
+    FILE * eeprom_file = fopen(sim_config.eeprom_file, "wb");
+    if (eeprom_file == nullptr){
+        fprintf(stderr, "native simulation: cannot write %s\n", sim_config.eeprom_file);
+        return;
+    }
+    fwrite(content, 1, eeprom_size, eeprom_file);
+    fclose(eeprom_file);
+}
+
+uint8_t EEPROMClass::read(int address){
+    uint8_t value;
+    return get(address, value);
+}
+
+void EEPROMClass::write(int address, uint8_t value){
+    put(address, value);
+}
@@ -0,0 +1,353 @@
+#include "SparkFun_u-blox_GNSS_Arduino_Library.h"
+
+// the receiver is powered by this pin, as on the logger PCB (see firmware_configuration.h)
+static constexpr uint8_t simulated_gnss_power_pin {18};
+
+// UBX-NAV-PVT poll: request, wait for the navigation solution, read 100 bytes at 100 kHz
+static constexpr uint64_t pvt_poll_us {25000};
+// UBX-CFG-* message with acknowledgement
+static constexpr uint64_t config_message_us {15000};
+// read the number of bytes available (registers 0xFD, 0xFE)
+static constexpr uint64_t bytes_available_us {500};
+// read a periodic UBX-NAV-PVT, 100 bytes at 100 kHz
+static constexpr uint64_t auto_pvt_read_us {10000};
+// the receiver needs a bit of time after power up before answering on I2C
+static constexpr uint64_t receiver_boot_us {300000};
+// one byte over I2C at 100 kHz, with the ack
+static constexpr uint64_t i2c_byte_us {90};
+// a UBX-MGA-INI message, 56 bytes
+static constexpr uint64_t mga_ini_message_us {56 * i2c_byte_us};
+
+// the simulated navigation database: a series of UBX-MGA-DBD messages
+static constexpr size_t database_number_of_messages {30};
+static constexpr size_t database_payload_size {108};
+static constexpr size_t ubx_overhead {8};  // sync chars, class, id, length, checksum
+static constexpr uint8_t ubx_class_mga {0x13};
+static constexpr uint8_t ubx_id_mga_dbd {0x80};
+// the ephemeris are valid for about 4 hours
+static constexpr uint64_t database_validity_us {4ULL * 3600ULL * 1000000ULL};
+
+// a fixed location, with a bit of noise: Blindern, Oslo
+static constexpr int32_t simulated_latitude {599400000};
+static constexpr int32_t simulated_longitude {107200000};
+
+static uint32_t noise_state {0x9E3779B9};
+static int32_t position_noise(int32_t amplitude){
+    noise_state = noise_state * 1664525UL + 1013904223UL;
+    return static_cast<int32_t>((noise_state >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+// days since the epoch to civil date, see http://howardhinnant.github.io/date_algorithms.html
+static void civil_from_days(int64_t days, int & year, unsigned & month, unsigned & day){
+    days += 719468;
+    int64_t const era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned const day_of_era = static_cast<unsigned>(days - era * 146097);
+    unsigned const year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int64_t const year_0 = static_cast<int64_t>(year_of_era) + era * 400;
+    unsigned const day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    unsigned const month_position = (5 * day_of_year + 2) / 153;
+    day = day_of_year - (153 * month_position + 2) / 5 + 1;
+    month = month_position < 10 ? month_position + 3 : month_position - 9;
+    year = static_cast<int>(year_0 + (month <= 2));
+}
+
+bool SFE_UBLOX_GNSS::receiver_answers(void) const {
+    return (i2c_port != nullptr) && i2c_port->is_started() && sim_pin_is_high(simulated_gnss_power_pin) &&
+           (sim_micros() - sim_pin_high_since_us(simulated_gnss_power_pin) >= receiver_boot_us);
+}
+
+bool SFE_UBLOX_GNSS::begin(TwoWire & wire_port, uint8_t device_address, uint16_t max_wait, bool assume_success){
+    (void)device_address;
+    (void)assume_success;
+
+    i2c_port = &wire_port;
+    fresh_fields = 0;
+    // the receiver configuration is lost at each power cycle
+    measurement_period_us = 1000000ULL;
+    auto_pvt_callback = nullptr;
+    auto_pvt_callback_pending = false;
+    // and so is the navigation database, without a backup battery
+    time_assisted = false;
+    database_assisted = false;
+
+    if (!receiver_answers()){
+        // the library retries until max_wait before giving up
+        sim_advance_micros(1000ULL * max_wait, sim_counters.micros_in_peripherals);
+        return false;
+    }
+
+    sim_advance_micros(config_message_us, sim_counters.micros_in_peripherals);
+    return true;
+}
+
+bool SFE_UBLOX_GNSS::setI2COutput(uint8_t com_settings, uint16_t max_wait){
+    (void)com_settings;
+    (void)max_wait;
+    sim_advance_micros(config_message_us, sim_counters.micros_in_peripherals);
+    return receiver_answers();
+}
+
+bool SFE_UBLOX_GNSS::setDynamicModel(dynModel new_dynamic_model, uint16_t max_wait){
+    (void)new_dynamic_model;
+    (void)max_wait;
+    sim_advance_micros(2 * config_message_us, sim_counters.micros_in_peripherals);
+    return receiver_answers();
+}
+
+void SFE_UBLOX_GNSS::poll_pvt(void){
+    if (!receiver_answers()){
+        sim_advance_micros(1000ULL * defaultMaxWait, sim_counters.micros_in_peripherals);
+        memset(&pvt, 0, sizeof(pvt));
+        fresh_fields = 0;
+        return;
+    }
+
+    sim_advance_micros(pvt_poll_us, sim_counters.micros_in_peripherals);
+    compute_pvt();
+}
+
+uint64_t SFE_UBLOX_GNSS::time_to_fix_us(void) const {
+    uint64_t const cold_us = 1000ULL * sim_config.gnss_time_to_fix_ms;
+    if (!time_assisted || !database_assisted){
+        return cold_us;
+    }
+
+    // hot start from the moment the database is pushed
+    uint64_t const hot_us = (database_pushed_us - sim_pin_high_since_us(simulated_gnss_power_pin)) + 1000ULL * sim_config.gnss_hot_time_to_fix_ms;
+    return hot_us < cold_us ? hot_us : cold_us;
+}
+
+void SFE_UBLOX_GNSS::compute_pvt(void){
+    uint64_t const powered_us = sim_micros() - sim_pin_high_since_us(simulated_gnss_power_pin);
+    bool const has_fix = (powered_us >= time_to_fix_us());
+
+    uint64_t const utc_ms = 1000ULL * sim_config.gnss_start_posix + sim_micros() / 1000ULL;
+    uint64_t const utc_seconds = utc_ms / 1000ULL;
+    int year;
+    unsigned month;
+    unsigned day;
+    civil_from_days(static_cast<int64_t>(utc_seconds / 86400ULL), year, month, day);
+
+    pvt.fix_type = has_fix ? 3 : 0;
+    pvt.millisecond = static_cast<uint16_t>(utc_ms % 1000ULL);
+    pvt.second = static_cast<uint8_t>(utc_seconds % 60ULL);
+    pvt.minute = static_cast<uint8_t>((utc_seconds / 60ULL) % 60ULL);
+    pvt.hour = static_cast<uint8_t>((utc_seconds / 3600ULL) % 24ULL);
+    pvt.day = static_cast<uint8_t>(day);
+    pvt.month = static_cast<uint8_t>(month);
+    pvt.year = static_cast<uint16_t>(year);
+    pvt.latitude = has_fix ? simulated_latitude + position_noise(50) : 0;
+    pvt.longitude = has_fix ? simulated_longitude + position_noise(50) : 0;
+    pvt.altitude_msl = has_fix ? 94000 + position_noise(2000) : 0;
+    pvt.ground_speed = has_fix ? position_noise(20) : 0;
+    pvt.siv = has_fix ? 9 : 2;
+    pvt.heading = 0;
+    pvt.pdop = has_fix ? 150 : 9999;
+
+    fresh_fields = UINT32_MAX;
+}
+
+bool SFE_UBLOX_GNSS::setMeasurementRate(uint16_t rate, uint16_t max_wait){
+    (void)max_wait;
+    sim_advance_micros(2 * config_message_us, sim_counters.micros_in_peripherals);
+    if (!receiver_answers() || rate == 0){
+        return false;
+    }
+    measurement_period_us = 1000ULL * rate;
+    return true;
+}
+
+bool SFE_UBLOX_GNSS::setAutoPVTcallbackPtr(void (*callback_pointer)(UBX_NAV_PVT_data_t *), uint16_t max_wait){
+    (void)max_wait;
+    sim_advance_micros(config_message_us, sim_counters.micros_in_peripherals);
+    if (!receiver_answers()){
+        return false;
+    }
+    auto_pvt_callback = callback_pointer;
+    // the first message comes at the next navigation epoch
+    next_auto_pvt_us = (sim_micros() / measurement_period_us + 1) * measurement_period_us;
+    auto_pvt_callback_pending = false;
+    return true;
+}
+
+bool SFE_UBLOX_GNSS::checkUblox(void){
+    if ((auto_pvt_callback == nullptr) || !receiver_answers()){
+        return false;
+    }
+
+    sim_advance_micros(bytes_available_us, sim_counters.micros_in_peripherals);
+    uint64_t const now = sim_micros();
+    if (now < next_auto_pvt_us){
+        return false;
+    }
+
+    // the receiver buffers the messages not read yet; they are all read, the last one wins
+    uint64_t const number_of_messages = (now - next_auto_pvt_us) / measurement_period_us + 1;
+    sim_advance_micros(number_of_messages * auto_pvt_read_us, sim_counters.micros_in_peripherals);
+    next_auto_pvt_us += number_of_messages * measurement_period_us;
+
+    compute_pvt();
+    auto_pvt_data.iTOW = static_cast<uint32_t>(((1000ULL * sim_config.gnss_start_posix + sim_micros() / 1000ULL) - 315964800000ULL) % 604800000ULL);
+    auto_pvt_data.year = pvt.year;
+    auto_pvt_data.month = pvt.month;
+    auto_pvt_data.day = pvt.day;
+    auto_pvt_data.hour = pvt.hour;
+    auto_pvt_data.min = pvt.minute;
+    auto_pvt_data.sec = pvt.second;
+    auto_pvt_data.nano = 1000000L * pvt.millisecond;
+    auto_pvt_data.fixType = pvt.fix_type;
+    auto_pvt_data.numSV = pvt.siv;
+    auto_pvt_data.lon = pvt.longitude;
+    auto_pvt_data.lat = pvt.latitude;
+    auto_pvt_data.hMSL = pvt.altitude_msl;
+    auto_pvt_data.gSpeed = pvt.ground_speed;
+    auto_pvt_data.headMot = pvt.heading;
+    auto_pvt_data.pDOP = pvt.pdop;
+    auto_pvt_callback_pending = true;
+    return true;
+}
+
+void SFE_UBLOX_GNSS::checkCallbacks(void){
+    if (auto_pvt_callback_pending && (auto_pvt_callback != nullptr)){
+        auto_pvt_callback_pending = false;
+        auto_pvt_callback(&auto_pvt_data);
+    }
+}
+
+bool SFE_UBLOX_GNSS::setUTCTimeAssistance(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second,
+                                          uint32_t nanos, uint16_t tAccS, uint32_t tAccNs, uint8_t source,
+                                          sfe_ublox_mga_assist_ack_e mgaAck, uint16_t maxWait){
+    (void)nanos; (void)tAccNs; (void)source; (void)mgaAck; (void)maxWait;
+    sim_advance_micros(mga_ini_message_us, sim_counters.micros_in_peripherals);
+    if (!receiver_answers()){
+        return false;
+    }
+
+    // only useful if within the accuracy given, with a bit of slack for the 1 s resolution
+    uint64_t const utc_seconds = sim_config.gnss_start_posix + sim_micros() / 1000000ULL;
+    int true_year;
+    unsigned true_month;
+    unsigned true_day;
+    civil_from_days(static_cast<int64_t>(utc_seconds / 86400ULL), true_year, true_month, true_day);
+    int64_t const true_second_of_day = static_cast<int64_t>(utc_seconds % 86400ULL);
+    int64_t const second_of_day = 3600LL * hour + 60LL * minute + second;
+    int64_t const error_seconds = second_of_day - true_second_of_day;
+    int64_t const accepted_error_seconds = static_cast<int64_t>(tAccS) + 1;
+    time_assisted = (year == true_year) && (month == true_month) && (day == true_day) &&
+                    (error_seconds <= accepted_error_seconds) && (-error_seconds <= accepted_error_seconds);
+    return true;
+}
+
+bool SFE_UBLOX_GNSS::setPositionAssistanceLLH(int32_t lat, int32_t lon, int32_t alt, uint32_t posAcc,
+                                              sfe_ublox_mga_assist_ack_e mgaAck, uint16_t maxWait){
+    (void)lat; (void)lon; (void)alt; (void)posAcc; (void)mgaAck; (void)maxWait;
+    sim_advance_micros(mga_ini_message_us, sim_counters.micros_in_peripherals);
+    return receiver_answers();
+}
+
+size_t SFE_UBLOX_GNSS::readNavigationDatabase(uint8_t * dataBytes, size_t maxNumDataBytes, uint16_t maxWait){
+    if (!receiver_answers()){
+        sim_advance_micros(1000ULL * maxWait, sim_counters.micros_in_peripherals);
+        return 0;
+    }
+
+    // the poll, then the database bytes
+    sim_advance_micros(pvt_poll_us, sim_counters.micros_in_peripherals);
+
+    // nothing worth dumping if the receiver did not navigate since power up
+    uint64_t const powered_us = sim_micros() - sim_pin_high_since_us(simulated_gnss_power_pin);
+    if (powered_us < time_to_fix_us()){
+        return 0;
+    }
+
+    uint64_t const dumped_us = sim_micros();
+    size_t number_of_bytes {0};
+    for (size_t crrt_message=0; crrt_message<database_number_of_messages; crrt_message++){
+        uint8_t message[database_payload_size + ubx_overhead] {0xB5, 0x62, ubx_class_mga, ubx_id_mga_dbd,
+                                                              static_cast<uint8_t>(database_payload_size & 0xFF),
+                                                              static_cast<uint8_t>(database_payload_size >> 8)};
+        // the dump time in the first message; arbitrary content otherwise
+        for (size_t i=0; i<database_payload_size; i++){
+            message[6 + i] = static_cast<uint8_t>(crrt_message + i);
+        }
+        if (crrt_message == 0){
+            memcpy(&message[6], &dumped_us, sizeof(dumped_us));
+        }
+        uint8_t checksum_a {0};
+        uint8_t checksum_b {0};
+        for (size_t i=2; i<6 + database_payload_size; i++){
+            checksum_a += message[i];
+            checksum_b += checksum_a;
+        }
+        message[6 + database_payload_size] = checksum_a;
+        message[7 + database_payload_size] = checksum_b;
+
+        // as in the library, the bytes that do not fit are lost
+        size_t const room = maxNumDataBytes - number_of_bytes;
+        size_t const number_to_copy = (room < sizeof(message)) ? room : sizeof(message);
+        memcpy(dataBytes + number_of_bytes, message, number_to_copy);
+        number_of_bytes += number_to_copy;
+        sim_advance_micros(sizeof(message) * i2c_byte_us, sim_counters.micros_in_peripherals);
+    }
+
+    return number_of_bytes;
+}
+
+size_t SFE_UBLOX_GNSS::pushAssistNowData(const uint8_t * dataBytes, size_t numDataBytes, sfe_ublox_mga_assist_ack_e mgaAck, uint16_t maxWait){
+    (void)mgaAck;
+    if (!receiver_answers()){
+        return 0;
+    }
+
+    // the library pushes the complete UBX messages one by one, maxWait ms apart
+    size_t number_of_bytes {0};
+    bool has_database {false};
+    while (number_of_bytes + ubx_overhead <= numDataBytes){
+        uint8_t const * message = dataBytes + number_of_bytes;
+        if ((message[0] != 0xB5) || (message[1] != 0x62)){
+            break;
+        }
+        size_t const message_size = ubx_overhead + (message[4] | (message[5] << 8));
+        if (number_of_bytes + message_size > numDataBytes){
+            break;
+        }
+
+        if ((number_of_bytes == 0) && (message[2] == ubx_class_mga) && (message[3] == ubx_id_mga_dbd)){
+            memcpy(&database_dumped_us, &message[6], sizeof(database_dumped_us));
+            has_database = true;
+        }
+
+        sim_advance_micros(message_size * i2c_byte_us + 1000ULL * maxWait, sim_counters.micros_in_peripherals);
+        number_of_bytes += message_size;
+    }
+
+    if (has_database && (sim_micros() - database_dumped_us < database_validity_us)){
+        database_assisted = true;
+        database_pushed_us = sim_micros();
+    }
+
+    return number_of_bytes;
+}
+
+void SFE_UBLOX_GNSS::refresh_if_stale(uint32_t field){
+    if (!(fresh_fields & field)){
+        poll_pvt();
+    }
+    fresh_fields &= ~field;
+}
+
+uint8_t SFE_UBLOX_GNSS::getFixType(uint16_t){ refresh_if_stale(field_fix_type); return pvt.fix_type; }
+uint16_t SFE_UBLOX_GNSS::getMillisecond(uint16_t){ refresh_if_stale(field_millisecond); return pvt.millisecond; }
+uint8_t SFE_UBLOX_GNSS::getSecond(uint16_t){ refresh_if_stale(field_second); return pvt.second; }
+uint8_t SFE_UBLOX_GNSS::getMinute(uint16_t){ refresh_if_stale(field_minute); return pvt.minute; }
+uint8_t SFE_UBLOX_GNSS::getHour(uint16_t){ refresh_if_stale(field_hour); return pvt.hour; }
+uint8_t SFE_UBLOX_GNSS::getDay(uint16_t){ refresh_if_stale(field_day); return pvt.day; }
+uint8_t SFE_UBLOX_GNSS::getMonth(uint16_t){ refresh_if_stale(field_month); return pvt.month; }
+uint16_t SFE_UBLOX_GNSS::getYear(uint16_t){ refresh_if_stale(field_year); return pvt.year; }
+int32_t SFE_UBLOX_GNSS::getLatitude(uint16_t){ refresh_if_stale(field_latitude); return pvt.latitude; }
+int32_t SFE_UBLOX_GNSS::getLongitude(uint16_t){ refresh_if_stale(field_longitude); return pvt.longitude; }
+int32_t SFE_UBLOX_GNSS::getAltitudeMSL(uint16_t){ refresh_if_stale(field_altitude_msl); return pvt.altitude_msl; }
+int32_t SFE_UBLOX_GNSS::getGroundSpeed(uint16_t){ refresh_if_stale(field_ground_speed); return pvt.ground_speed; }
+uint8_t SFE_UBLOX_GNSS::getSIV(uint16_t){ refresh_if_stale(field_siv); return pvt.siv; }
+int32_t SFE_UBLOX_GNSS::getHeading(uint16_t){ refresh_if_stale(field_heading); return pvt.heading; }
+uint16_t SFE_UBLOX_GNSS::getPDOP(uint16_t){ refresh_if_stale(field_pdop); return pvt.pdop; }
@@ -0,0 +1,23 @@
+#include "Arduino.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// entry point of the host (native) build: the same cycle as the Apollo3 core main, for a
+// given number of loop() calls, then a summary of the simulated timings and I/O
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void setup(void);
+void loop(void);
+
+int main(void){
+    sim_init();
+
+    setup();
+
+    for (unsigned long crrt_loop=0; crrt_loop<sim_config.number_of_loops; crrt_loop++){
+        loop();
+    }
+
+    sim_print_summary();
+
+    return 0;
+}
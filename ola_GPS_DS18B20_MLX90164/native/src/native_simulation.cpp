@@ -0,0 +1,279 @@
+#include "native_simulation.h"
+
+#include <chrono>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+
+Native_Simulation_Config sim_config;
+Native_Simulation_Counters sim_counters;
+
+//--------------------------------------------------------------------------------
+// configuration
+
+static unsigned long long env_or_default(char const * name, unsigned long long default_value){
+    char const * value = getenv(name);
+    if (value == nullptr || *value == '\0'){
+        return default_value;
+    }
+    return strtoull(value, nullptr, 10);
+}
+
+static void env_string_or_default(char const * name, char const * default_value, char * destination, size_t size){
+    char const * value = getenv(name);
+    snprintf(destination, size, "%s", (value == nullptr || *value == '\0') ? default_value : value);
+}
+
+// the firmware global constructors already use the clock (e.g. the RTC setup), before
+// main() runs: initialized on first use
+static std::chrono::steady_clock::time_point host_start(void){
+    static std::chrono::steady_clock::time_point const start {std::chrono::steady_clock::now()};
+    return start;
+}
+
+void sim_init(void){
+    sim_config.number_of_loops = env_or_default("OLA_NATIVE_LOOPS", 3);
+    env_string_or_default("OLA_NATIVE_SD_DIR", "native_sd_card", sim_config.sd_card_directory, sizeof(sim_config.sd_card_directory));
+    env_string_or_default("OLA_NATIVE_EEPROM", "native_eeprom.bin", sim_config.eeprom_file, sizeof(sim_config.eeprom_file));
+    sim_config.gnss_start_posix = env_or_default("OLA_NATIVE_START_POSIX", 1735732800ULL);  // 2025-01-01T12:00:00Z
+    sim_config.gnss_time_to_fix_ms = env_or_default("OLA_NATIVE_GNSS_TTFF_MS", 30000);
+    sim_config.gnss_hot_time_to_fix_ms = env_or_default("OLA_NATIVE_GNSS_HOT_TTFF_MS", 2000);
+    sim_config.number_of_ds18b20 = env_or_default("OLA_NATIVE_DS18B20", 8);
+    // about 64kB/s with preallocated files, see test/test_sdfat_speed_latency
+    sim_config.sd_sector_write_us = env_or_default("OLA_NATIVE_SD_WRITE_US", 8000);
+    sim_config.sd_sector_read_us = env_or_default("OLA_NATIVE_SD_READ_US", 1000);
+    sim_config.wdt_host_timeout_s = env_or_default("OLA_NATIVE_WDT_S", 10);
+    sim_config.quiet = env_or_default("OLA_NATIVE_QUIET", 0) != 0;
+}
+
+void sim_print_summary(void){
+    double const host_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - host_start()).count();
+    uint64_t const simulated_us = sim_micros();
+
+    fflush(stdout);
+    fprintf(stderr, "\n--- native simulation summary ---\n");
+    fprintf(stderr, "host (CPU) time:           %12.6f s\n", host_seconds);
+    fprintf(stderr, "simulated time:            %12.3f s\n", simulated_us / 1e6);
+    fprintf(stderr, "  in delay():              %12.3f s\n", sim_counters.micros_in_delay / 1e6);
+    fprintf(stderr, "  in deep sleep:           %12.3f s\n", sim_counters.micros_in_deep_sleep / 1e6);
+    fprintf(stderr, "  in peripheral transfers: %12.3f s\n", sim_counters.micros_in_peripherals / 1e6);
+    fprintf(stderr, "serial bytes:              %12llu\n", static_cast<unsigned long long>(sim_counters.serial_bytes));
+    fprintf(stderr, "SD files opened:           %12llu\n", static_cast<unsigned long long>(sim_counters.sd_files_opened));
+    fprintf(stderr, "SD bytes written:          %12llu\n", static_cast<unsigned long long>(sim_counters.sd_bytes_written));
+    fprintf(stderr, "SD sectors written:        %12llu\n", static_cast<unsigned long long>(sim_counters.sd_sectors_written));
+    fprintf(stderr, "SD sectors read:           %12llu\n", static_cast<unsigned long long>(sim_counters.sd_sectors_read));
+    fprintf(stderr, "1-wire bytes:              %12llu\n", static_cast<unsigned long long>(sim_counters.onewire_bytes));
+    fprintf(stderr, "RTC interrupts:            %12llu\n", static_cast<unsigned long long>(sim_counters.rtc_interrupts));
+    fprintf(stderr, "CTIMER interrupts:         %12llu\n", static_cast<unsigned long long>(sim_counters.ctimer_interrupts));
+    fprintf(stderr, "---------------------------------\n");
+}
+
+//--------------------------------------------------------------------------------
+// simulated clock and interrupts
+
+static uint64_t simulated_offset_us {0};
+
+static bool interrupts_enabled {true};
+static bool servicing_interrupts {false};
+
+static bool rtc_interrupt_enabled {false};
+static uint64_t next_rtc_tick_us {0};
+static constexpr uint64_t rtc_tick_us {1000000ULL};
+
+static bool ctimer_interrupt_enabled {false};
+static uint64_t next_ctimer_event_us {0};
+
+static bool stimer_frozen {false};
+static uint64_t stimer_frozen_since_us {0};
+static uint64_t stimer_frozen_total_us {0};
+
+uint64_t sim_micros(void){
+    uint64_t const host_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - host_start()).count();
+    return host_us + simulated_offset_us;
+}
+
+uint64_t sim_stimer_micros(void){
+    uint64_t const now = sim_micros();
+    uint64_t const frozen_us = stimer_frozen_total_us + (stimer_frozen ? now - stimer_frozen_since_us : 0);
+    return now - frozen_us;
+}
+
+void sim_stimer_freeze(bool freeze){
+    if (freeze && !stimer_frozen){
+        stimer_frozen_since_us = sim_micros();
+    }
+    if (!freeze && stimer_frozen){
+        stimer_frozen_total_us += sim_micros() - stimer_frozen_since_us;
+    }
+    stimer_frozen = freeze;
+}
+
+static void check_simulated_watchdog(void);
+
+void sim_advance_micros(uint64_t duration_us, uint64_t & counter){
+    simulated_offset_us += duration_us;
+    counter += duration_us;
+    check_simulated_watchdog();
+    sim_service_interrupts();
+}
+
+void sim_service_interrupts(void){
+    if (!interrupts_enabled || servicing_interrupts){
+        return;
+    }
+    servicing_interrupts = true;
+
+    uint64_t const now = sim_micros();
+    while (true){
+        bool const rtc_due = rtc_interrupt_enabled && next_rtc_tick_us <= now;
+        bool const ctimer_due = ctimer_interrupt_enabled && next_ctimer_event_us != 0 && next_ctimer_event_us <= now;
+
+        // fire in time order
+        if (ctimer_due && (!rtc_due || next_ctimer_event_us < next_rtc_tick_us)){
+            uint64_t const due_us = next_ctimer_event_us;
+            next_ctimer_event_us = 0;
+            sim_counters.ctimer_interrupts += 1;
+            sim_ctimer_expired(due_us);
+        }
+        else if (rtc_due){
+            next_rtc_tick_us += rtc_tick_us;
+            sim_counters.rtc_interrupts += 1;
+            if (am_rtc_isr){
+                am_rtc_isr();
+            }
+        }
+        else {
+            break;
+        }
+    }
+
+    servicing_interrupts = false;
+}
+
+void sim_deep_sleep_until_next_interrupt(void){
+    bool const ctimer_pending = ctimer_interrupt_enabled && next_ctimer_event_us != 0;
+
+    if (!rtc_interrupt_enabled && !ctimer_pending){
+        fprintf(stderr, "native simulation: deep sleep with no wake up interrupt enabled; would sleep forever\n");
+        sim_print_summary();
+        exit(2);
+    }
+
+    uint64_t next_interrupt_us = rtc_interrupt_enabled ? next_rtc_tick_us : UINT64_MAX;
+    if (ctimer_pending && next_ctimer_event_us < next_interrupt_us){
+        next_interrupt_us = next_ctimer_event_us;
+    }
+
+    uint64_t const now = sim_micros();
+    if (next_interrupt_us > now){
+        // the core is stopped during deep sleep: interrupts wake it up even if masked
+        bool const previous_interrupts_enabled = interrupts_enabled;
+        interrupts_enabled = true;
+        sim_advance_micros(next_interrupt_us - now, sim_counters.micros_in_deep_sleep);
+        interrupts_enabled = previous_interrupts_enabled;
+    }
+}
+
+void sim_enable_rtc_interrupt(bool enable){
+    if (enable && !rtc_interrupt_enabled){
+        next_rtc_tick_us = sim_micros() + rtc_tick_us;
+    }
+    rtc_interrupt_enabled = enable;
+}
+
+void sim_enable_ctimer_interrupt(bool enable){
+    ctimer_interrupt_enabled = enable;
+}
+
+void sim_schedule_ctimer_event(uint64_t due_us){
+    next_ctimer_event_us = due_us;
+}
+
+void noInterrupts(void){
+    interrupts_enabled = false;
+}
+
+void interrupts(void){
+    interrupts_enabled = true;
+    sim_service_interrupts();
+}
+
+//--------------------------------------------------------------------------------
+// watchdog
+// two checks: on the host clock, to catch the while(true){} used to get rebooted, and on
+// the simulated clock, to catch the long delays without wdt.restart() that would get the
+// board rebooted
+
+static bool watchdog_enabled {false};
+static uint64_t watchdog_last_kick_us {0};
+static uint64_t watchdog_timeout_us {32000000ULL};
+
+static void host_watchdog_handler(int){
+    static char const message[] = "\nnative simulation: watchdog reset (no wdt.restart() on the host clock)\n";
+    fflush(stdout);
+    ssize_t const ignored = write(STDERR_FILENO, message, sizeof(message) - 1);
+    (void)ignored;
+    _exit(3);
+}
+
+static void check_simulated_watchdog(void){
+    if (watchdog_enabled && (sim_micros() - watchdog_last_kick_us > watchdog_timeout_us)){
+        fprintf(stderr, "\nnative simulation: watchdog reset (no wdt.restart() for %llu simulated us)\n",
+                static_cast<unsigned long long>(sim_micros() - watchdog_last_kick_us));
+        sim_print_summary();
+        exit(3);
+    }
+}
+
+void sim_watchdog_kick(void){
+    if (!watchdog_enabled){
+        return;
+    }
+    check_simulated_watchdog();
+    watchdog_last_kick_us = sim_micros();
+    alarm(static_cast<unsigned int>(sim_config.wdt_host_timeout_s));
+}
+
+void sim_watchdog_enable(bool enable){
+    watchdog_enabled = enable;
+    if (enable){
+        signal(SIGALRM, host_watchdog_handler);
+        watchdog_last_kick_us = sim_micros();
+        alarm(static_cast<unsigned int>(sim_config.wdt_host_timeout_s));
+    }
+    else {
+        alarm(0);
+    }
+}
+
+void sim_watchdog_set_timeout(uint64_t timeout_us){
+    watchdog_timeout_us = timeout_us;
+}
+
+//--------------------------------------------------------------------------------
+// the Apollo3 core watchdog library
+
+#include "WDT.h"
+
+void APM3_WDT::configure(uint8_t clock, uint32_t interrupt, uint32_t reset){
+    (void)interrupt;
+    uint64_t const tick_us = (clock == WDT_16HZ) ? 62500ULL : 1000000ULL;
+    sim_watchdog_set_timeout(tick_us * reset);
+}
+
+void APM3_WDT::start(void){
+    sim_watchdog_enable(true);
+}
+
+void APM3_WDT::stop(void){
+    sim_watchdog_enable(false);
+}
+
+void APM3_WDT::restart(void){
+    sim_watchdog_kick();
+}
@@ -0,0 +1,393 @@
+#include "OneWire.h"
+
+//--------------------------------------------------------------------------------
+// the simulated DS18B20 sensors
+
+// the sensors are powered by this pin, as on the logger PCB (see firmware_configuration.h)
+static constexpr uint8_t simulated_ds18b20_power_pin {32};
+
+// durations of the 1-wire time slots, standard speed
+static constexpr uint64_t reset_duration_us {960};
+static constexpr uint64_t slot_duration_us {70};
+
+static constexpr uint8_t scratchpad_length {9};
+
+struct Simulated_DS18B20 {
+    uint8_t address[8];
+    uint8_t scratchpad[scratchpad_length];
+    uint8_t eeprom_th_tl_config[3];
+    uint64_t powered_since_us;
+    uint64_t conversion_end_us;
+    int16_t pending_raw;
+    bool conversion_pending;
+};
+
+static constexpr size_t max_number_of_sensors {64};
+static Simulated_DS18B20 sensors[max_number_of_sensors];
+static size_t number_of_sensors {0};
+
+// small deterministic generator for the measurement noise
+static uint32_t noise_state {0x12345678};
+static float uniform_noise(void){
+    noise_state = noise_state * 1664525UL + 1013904223UL;
+    return static_cast<float>(noise_state >> 8) / 16777216.0f - 0.5f;
+}
+
+static uint8_t resolution_bits(Simulated_DS18B20 const & sensor){
+    return 9 + ((sensor.scratchpad[4] >> 5) & 0x03);
+}
+
+static uint64_t conversion_duration_us(Simulated_DS18B20 const & sensor){
+    return 93750ULL << (resolution_bits(sensor) - 9);
+}
+
+static void update_scratchpad_crc(Simulated_DS18B20 & sensor){
+    sensor.scratchpad[8] = OneWire::crc8(sensor.scratchpad, 8);
+}
+
+static void power_up(Simulated_DS18B20 & sensor){
+    // power on value: 85 celsius, configuration from the sensor EEPROM
+    sensor.scratchpad[0] = 0x50;
+    sensor.scratchpad[1] = 0x05;
+    sensor.scratchpad[2] = sensor.eeprom_th_tl_config[0];
+    sensor.scratchpad[3] = sensor.eeprom_th_tl_config[1];
+    sensor.scratchpad[4] = sensor.eeprom_th_tl_config[2];
+    sensor.scratchpad[5] = 0xFF;
+    sensor.scratchpad[6] = 0x0C;
+    sensor.scratchpad[7] = 0x10;
+    update_scratchpad_crc(sensor);
+    sensor.conversion_pending = false;
+    sensor.powered_since_us = sim_pin_high_since_us(simulated_ds18b20_power_pin);
+}
+
+static void create_sensors(void){
+    if (number_of_sensors != 0){
+        return;
+    }
+
+    number_of_sensors = sim_config.number_of_ds18b20 < max_number_of_sensors ? sim_config.number_of_ds18b20 : max_number_of_sensors;
+
+    for (size_t ind=0; ind<number_of_sensors; ind++){
+        Simulated_DS18B20 & sensor = sensors[ind];
+        sensor.address[0] = 0x28;
+        for (size_t byte_ind=1; byte_ind<7; byte_ind++){
+            sensor.address[byte_ind] = static_cast<uint8_t>(0x11 * byte_ind + 0x37 * ind);
+        }
+        sensor.address[7] = OneWire::crc8(sensor.address, 7);
+
+        sensor.eeprom_th_tl_config[0] = 0x4B;
+        sensor.eeprom_th_tl_config[1] = 0x46;
+        sensor.eeprom_th_tl_config[2] = 0x7F;  // 12 bits
+
+        power_up(sensor);
+        sensor.powered_since_us = 0;
+    }
+}
+
+static bool bus_powered(void){
+    create_sensors();
+
+    if (!sim_pin_is_high(simulated_ds18b20_power_pin)){
+        return false;
+    }
+
+    // the sensors lose their scratchpad when the power is cut
+    uint64_t const powered_since_us = sim_pin_high_since_us(simulated_ds18b20_power_pin);
+    for (size_t ind=0; ind<number_of_sensors; ind++){
+        if (sensors[ind].powered_since_us != powered_since_us){
+            power_up(sensors[ind]);
+        }
+    }
+
+    return true;
+}
+
+// a slowly varying temperature, different for each sensor, with a bit of noise
+static int16_t measure_raw(size_t sensor_index, uint8_t resolution){
+    double const seconds = static_cast<double>(sim_config.gnss_start_posix) + sim_micros() / 1e6;
+    double const celsius = 4.0 + 2.0 * sin(2.0 * PI * seconds / 86400.0) + 0.05 * sensor_index + 0.12 * uniform_noise();
+
+    int16_t raw = static_cast<int16_t>(lround(celsius * 16.0));
+    // the lowest bits are undefined below 12 bits resolution; the sensors read them as 0
+    raw &= static_cast<int16_t>(0xFFFF << (12 - resolution));
+    return raw;
+}
+
+static void complete_conversions(void){
+    uint64_t const now = sim_micros();
+    for (size_t ind=0; ind<number_of_sensors; ind++){
+        Simulated_DS18B20 & sensor = sensors[ind];
+        if (sensor.conversion_pending && now >= sensor.conversion_end_us){
+            sensor.scratchpad[0] = static_cast<uint8_t>(sensor.pending_raw & 0xFF);
+            sensor.scratchpad[1] = static_cast<uint8_t>((sensor.pending_raw >> 8) & 0xFF);
+            update_scratchpad_crc(sensor);
+            sensor.conversion_pending = false;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------
+// the bus: ROM commands, then function commands, at the byte level
+
+enum class Bus_State {
+    idle,
+    rom_command,
+    match_rom,
+    function_command,
+    write_scratchpad,
+    read_scratchpad,
+};
+
+static Bus_State bus_state {Bus_State::idle};
+static bool selected[max_number_of_sensors];
+static uint8_t match_rom_buffer[8];
+static size_t transfer_index {0};
+
+static void select_all(bool value){
+    for (size_t ind=0; ind<number_of_sensors; ind++){
+        selected[ind] = value;
+    }
+}
+
+static void function_command(uint8_t command){
+    complete_conversions();
+
+    switch (command){
+        case 0x44:  // convert T
+            for (size_t ind=0; ind<number_of_sensors; ind++){
+                if (selected[ind]){
+                    sensors[ind].conversion_pending = true;
+                    sensors[ind].conversion_end_us = sim_micros() + conversion_duration_us(sensors[ind]);
+                    sensors[ind].pending_raw = measure_raw(ind, resolution_bits(sensors[ind]));
+                }
+            }
+            bus_state = Bus_State::idle;
+            break;
+
+        case 0xBE:  // read scratchpad
+            bus_state = Bus_State::read_scratchpad;
+            transfer_index = 0;
+            break;
+
+        case 0x4E:  // write scratchpad: TH, TL, configuration
+            bus_state = Bus_State::write_scratchpad;
+            transfer_index = 0;
+            break;
+
+        case 0x48:  // copy scratchpad to EEPROM
+            for (size_t ind=0; ind<number_of_sensors; ind++){
+                if (selected[ind]){
+                    memcpy(sensors[ind].eeprom_th_tl_config, &sensors[ind].scratchpad[2], 3);
+                }
+            }
+            sim_advance_micros(10000, sim_counters.micros_in_peripherals);
+            bus_state = Bus_State::idle;
+            break;
+
+        case 0xB8:  // recall EEPROM
+            for (size_t ind=0; ind<number_of_sensors; ind++){
+                if (selected[ind]){
+                    memcpy(&sensors[ind].scratchpad[2], sensors[ind].eeprom_th_tl_config, 3);
+                    update_scratchpad_crc(sensors[ind]);
+                }
+            }
+            bus_state = Bus_State::idle;
+            break;
+
+        default:
+            bus_state = Bus_State::idle;
+            break;
+    }
+}
+
+OneWire::OneWire(uint8_t pin) : pin{pin} {}
+
+uint8_t OneWire::reset(void){
+    sim_advance_micros(reset_duration_us, sim_counters.micros_in_peripherals);
+
+    if (!bus_powered() || number_of_sensors == 0){
+        bus_state = Bus_State::idle;
+        return 0;
+    }
+
+    bus_state = Bus_State::rom_command;
+    select_all(false);
+    return 1;
+}
+
+void OneWire::select(const uint8_t rom[8]){
+    write(0x55);
+    for (size_t ind=0; ind<8; ind++){
+        write(rom[ind]);
+    }
+}
+
+void OneWire::skip(void){
+    write(0xCC);
+}
+
+void OneWire::write(uint8_t value, uint8_t power){
+    (void)power;
+    sim_advance_micros(8 * slot_duration_us, sim_counters.micros_in_peripherals);
+    sim_counters.onewire_bytes += 1;
+
+    if (!bus_powered()){
+        return;
+    }
+
+    switch (bus_state){
+        case Bus_State::rom_command:
+            if (value == 0x55){
+                bus_state = Bus_State::match_rom;
+                transfer_index = 0;
+            }
+            else if (value == 0xCC){
+                select_all(true);
+                bus_state = Bus_State::function_command;
+            }
+            else {
+                bus_state = Bus_State::idle;
+            }
+            break;
+
+        case Bus_State::match_rom:
+            match_rom_buffer[transfer_index++] = value;
+            if (transfer_index == 8){
+                for (size_t ind=0; ind<number_of_sensors; ind++){
+                    selected[ind] = (memcmp(sensors[ind].address, match_rom_buffer, 8) == 0);
+                }
+                bus_state = Bus_State::function_command;
+            }
+            break;
+
+        case Bus_State::function_command:
+            function_command(value);
+            break;
+
+        case Bus_State::write_scratchpad:
+            for (size_t ind=0; ind<number_of_sensors; ind++){
+                if (selected[ind]){
+                    sensors[ind].scratchpad[2 + transfer_index] = (transfer_index == 2) ? static_cast<uint8_t>((value & 0x60) | 0x1F) : value;
+                    update_scratchpad_crc(sensors[ind]);
+                }
+            }
+            transfer_index += 1;
+            if (transfer_index == 3){
+                bus_state = Bus_State::idle;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void OneWire::write_bytes(const uint8_t * buffer, uint16_t count, bool power){
+    for (uint16_t ind=0; ind<count; ind++){
+        write(buffer[ind], power);
+    }
+}
+
+uint8_t OneWire::read(void){
+    sim_advance_micros(8 * slot_duration_us, sim_counters.micros_in_peripherals);
+    sim_counters.onewire_bytes += 1;
+
+    if (!bus_powered() || bus_state != Bus_State::read_scratchpad){
+        return 0xFF;
+    }
+
+    complete_conversions();
+
+    // several sensors answering at the same time: the open drain bus is a wired AND
+    uint8_t value {0xFF};
+    if (transfer_index < scratchpad_length){
+        for (size_t ind=0; ind<number_of_sensors; ind++){
+            if (selected[ind]){
+                value &= sensors[ind].scratchpad[transfer_index];
+            }
+        }
+    }
+    transfer_index += 1;
+    return value;
+}
+
+void OneWire::read_bytes(uint8_t * buffer, uint16_t count){
+    for (uint16_t ind=0; ind<count; ind++){
+        buffer[ind] = read();
+    }
+}
+
+void OneWire::write_bit(uint8_t value){
+    (void)value;
+    sim_advance_micros(slot_duration_us, sim_counters.micros_in_peripherals);
+}
+
+uint8_t OneWire::read_bit(void){
+    sim_advance_micros(slot_duration_us, sim_counters.micros_in_peripherals);
+
+    if (!bus_powered()){
+        return 1;
+    }
+
+    // after a convert T, the sensors hold the bus low until the conversion is done
+    complete_conversions();
+    for (size_t ind=0; ind<number_of_sensors; ind++){
+        if (sensors[ind].conversion_pending){
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void OneWire::depower(void){}
+
+//--------------------------------------------------------------------------------
+// search: the simulated sensors are returned one after the other
+
+void OneWire::reset_search(void){
+    search_index = 0;
+}
+
+bool OneWire::search(uint8_t * new_address, bool search_mode){
+    (void)search_mode;
+
+    if (!reset()){
+        reset_search();
+        return false;
+    }
+
+    // the search ROM command, then 3 time slots per address bit
+    sim_advance_micros((8 + 3 * 64) * slot_duration_us, sim_counters.micros_in_peripherals);
+    sim_counters.onewire_bytes += 1 + 3 * 8;
+    bus_state = Bus_State::idle;
+
+    if (search_index >= number_of_sensors){
+        reset_search();
+        return false;
+    }
+
+    memcpy(new_address, sensors[search_index].address, 8);
+    search_index += 1;
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+// Dallas / Maxim CRC8, same as the OneWire library
+
+uint8_t OneWire::crc8(const uint8_t * address, uint8_t length){
+    uint8_t crc {0};
+
+    while (length--){
+        uint8_t in_byte = *address++;
+        for (uint8_t bit_ind=8; bit_ind; bit_ind--){
+            uint8_t const mix = (crc ^ in_byte) & 0x01;
+            crc >>= 1;
+            if (mix){
+                crc ^= 0x8C;
+            }
+            in_byte >>= 1;
+        }
+    }
+
+    return crc;
+}
@@ -0,0 +1,262 @@
+#include "SdFat.h"
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+static constexpr uint64_t sector_size {512};
+
+// card initialization: power up, CMD0 / CMD8 / ACMD41 loop, reading the MBR, boot sector, FAT
+static constexpr uint64_t card_init_us {40000};
+
+static void sd_sectors_read(uint64_t number_of_sectors){
+    sim_counters.sd_sectors_read += number_of_sectors;
+    sim_advance_micros(number_of_sectors * sim_config.sd_sector_read_us, sim_counters.micros_in_peripherals);
+}
+
+static void sd_sectors_written(uint64_t number_of_sectors){
+    sim_counters.sd_sectors_written += number_of_sectors;
+    sim_advance_micros(number_of_sectors * sim_config.sd_sector_write_us, sim_counters.micros_in_peripherals);
+}
+
+static void host_path(const char * path, char * buffer, size_t size){
+    snprintf(buffer, size, "%s/%s", sim_config.sd_card_directory, path);
+}
+
+//--------------------------------------------------------------------------------
+// the volume
+
+bool SdFs::begin(SdSpiConfig config){
+    (void)config;
+
+    if (mkdir(sim_config.sd_card_directory, 0755) != 0 && errno != EEXIST){
+        fprintf(stderr, "native simulation: cannot create %s\n", sim_config.sd_card_directory);
+        return false;
+    }
+
+    sim_advance_micros(card_init_us, sim_counters.micros_in_peripherals);
+    sd_sectors_read(3);
+    return true;
+}
+
+void SdFs::end(void){}
+
+bool SdFs::exists(const char * path){
+    // one directory sector to look up
+    sd_sectors_read(1);
+
+    char full_path[512];
+    host_path(path, full_path, sizeof(full_path));
+    struct stat file_stat;
+    return stat(full_path, &file_stat) == 0;
+}
+
+bool SdFs::remove(const char * path){
+    sd_sectors_read(1);
+    sd_sectors_written(2);
+
+    char full_path[512];
+    host_path(path, full_path, sizeof(full_path));
+    return unlink(full_path) == 0;
+}
+
+//--------------------------------------------------------------------------------
+// the files
+
+FsFile::~FsFile(){
+    if (host_file != nullptr){
+        fclose(host_file);
+    }
+}
+
+bool FsFile::open(const char * path, oflag_t oflag){
+    if (host_file != nullptr){
+        return false;
+    }
+
+    char full_path[512];
+    host_path(path, full_path, sizeof(full_path));
+
+    // directory lookup
+    sd_sectors_read(1);
+
+    struct stat file_stat;
+    bool const exists = (stat(full_path, &file_stat) == 0);
+
+    if (!exists && !(oflag & O_CREAT)){
+        return false;
+    }
+
+    host_file = fopen(full_path, exists ? "r+b" : "w+b");
+    if (host_file == nullptr){
+        return false;
+    }
+
+    file_size = exists ? static_cast<uint64_t>(file_stat.st_size) : 0;
+    position = (oflag & O_AT_END) ? file_size : 0;
+    cached_sector = no_sector;
+    cache_dirty = false;
+    directory_entry_dirty = !exists;
+
+    sim_counters.sd_files_opened += 1;
+    return true;
+}
+
+void FsFile::access_sectors(uint64_t start, size_t size, bool writing){
+    uint64_t crrt = start;
+    uint64_t const end = start + size;
+
+    while (crrt < end){
+        uint64_t const sector = crrt / sector_size;
+        uint64_t const sector_start = sector * sector_size;
+        bool const whole_sector = (crrt == sector_start) && (end - crrt >= sector_size);
+
+        if (whole_sector && sector != cached_sector){
+            // whole sectors go directly to / from the card
+            if (writing){
+                sd_sectors_written(1);
+            }
+            else {
+                sd_sectors_read(1);
+            }
+            crrt = sector_start + sector_size;
+            continue;
+        }
+
+        if (sector != cached_sector){
+            flush_cache();
+            // a partial write at the end of the file does not need the old content
+            if (!writing || crrt != sector_start || sector_start < file_size){
+                sd_sectors_read(1);
+            }
+            cached_sector = sector;
+        }
+
+        if (writing){
+            cache_dirty = true;
+        }
+
+        crrt = (sector_start + sector_size < end) ? sector_start + sector_size : end;
+    }
+}
+
+void FsFile::flush_cache(void){
+    if (cache_dirty){
+        sd_sectors_written(1);
+        cache_dirty = false;
+    }
+}
+
+size_t FsFile::write(uint8_t c){
+    return write(&c, 1);
+}
+
+size_t FsFile::write(const uint8_t * buffer, size_t size){
+    if (host_file == nullptr){
+        setWriteError();
+        return 0;
+    }
+
+    access_sectors(position, size, true);
+
+    if (fseeko(host_file, static_cast<off_t>(position), SEEK_SET) != 0 || fwrite(buffer, 1, size, host_file) != size){
+        setWriteError();
+        return 0;
+    }
+
+    position += size;
+    if (position > file_size){
+        file_size = position;
+        directory_entry_dirty = true;
+    }
+
+    sim_counters.sd_bytes_written += size;
+    return size;
+}
+
+int FsFile::read(void * buffer, size_t size){
+    if (host_file == nullptr){
+        return -1;
+    }
+
+    if (position >= file_size){
+        return 0;
+    }
+    if (position + size > file_size){
+        size = static_cast<size_t>(file_size - position);
+    }
+
+    access_sectors(position, size, false);
+
+    if (fseeko(host_file, static_cast<off_t>(position), SEEK_SET) != 0){
+        return -1;
+    }
+    size_t const number_read = fread(buffer, 1, size, host_file);
+    position += number_read;
+    return static_cast<int>(number_read);
+}
+
+int FsFile::read(void){
+    uint8_t value;
+    return (read(&value, 1) == 1) ? value : -1;
+}
+
+bool FsFile::seekSet(uint64_t new_position){
+    if (host_file == nullptr || new_position > file_size){
+        return false;
+    }
+    position = new_position;
+    return true;
+}
+
+bool FsFile::preAllocate(uint64_t length){
+    if (host_file == nullptr || file_size != 0 || length == 0){
+        return false;
+    }
+
+    if (ftruncate(fileno(host_file), static_cast<off_t>(length)) != 0){
+        return false;
+    }
+
+    // a contiguous chain of clusters: a few FAT sectors, and the directory entry
+    uint64_t const fat_sectors = 1 + length / (32768ULL * 128ULL);
+    sd_sectors_read(fat_sectors);
+    sd_sectors_written(2 * fat_sectors + 1);
+
+    file_size = length;
+    return true;
+}
+
+bool FsFile::sync(void){
+    if (host_file == nullptr){
+        return false;
+    }
+
+    flush_cache();
+
+    if (directory_entry_dirty){
+        // read modify write of the directory sector
+        sd_sectors_read(1);
+        sd_sectors_written(1);
+        directory_entry_dirty = false;
+    }
+
+    return fflush(host_file) == 0;
+}
+
+void FsFile::flush(void){
+    sync();
+}
+
+bool FsFile::close(void){
+    if (host_file == nullptr){
+        return false;
+    }
+
+    bool const result = sync();
+    fclose(host_file);
+    host_file = nullptr;
+    cached_sector = no_sector;
+    return result;
+}
@@ -2,6 +2,7 @@
 
 #include "firmware_configuration.h"
 #include "user_configuration.h"
+#include "log_utils.h"
 #include "watchdog_manager.h"
 #include "time_manager.h"
 #include "thermistors_manager.h"
@@ -10,6 +11,8 @@
 #include "sleep_manager.h"
 #include "gnss_manager.h"
 #include "mlx90164_manager.h"
+#include "power_profiler.h"
+#include "trace_log.h"
 
 void setup()
 {
@@ -46,18 +49,23 @@ void setup()
   delay(100);
   wdt.restart();
 
-  print_firmware_config();
-  wdt.restart();
+  // keep the trace of the previous boot if the reset preserved it
+  trace_log.start(boot_counter_instance.get_boot_number());
 
-  print_all_user_configs();
-  wdt.restart();
+  if constexpr (LOG_ENABLED(info)){
+    print_firmware_config();
+    wdt.restart();
+
+    print_all_user_configs();
+    wdt.restart();
+  }
 
   analogReadResolution(14);
   delay(100);
   int read_PIN_PWR_O_3 = analogRead(PIN_PWR_O_3);
-  PRINTLN_VAR(read_PIN_PWR_O_3);
+  LOG_PRINTLN_VAR(info, read_PIN_PWR_O_3);
   float read_input_voltage = ((float) read_PIN_PWR_O_3) * 3.0 * 1.8 / 16348. * 1.58;
-  PRINTLN_VAR(read_input_voltage);
+  LOG_PRINTLN_VAR(info, read_input_voltage);
 
   pinMode(PIN_QWIIC_PWR, OUTPUT);
   digitalWrite(PIN_QWIIC_PWR, LOW);
@@ -66,7 +74,7 @@ void setup()
   digitalWrite(PIN_ICM_PWR, LOW);
 
   uint16_t crrt_boot_nbr = boot_counter_instance.get_boot_number();
-  PRINTLN_VAR(crrt_boot_nbr);
+  LOG_PRINTLN_VAR(info, crrt_boot_nbr);
 
   pinMode(PIN_STAT_LED, OUTPUT);
   pinMode(PIN_PWR_LED, OUTPUT);
@@ -164,6 +172,9 @@ void setup()
 
 void loop()
 {
+  power_profiler.start_wakeup();
+
+  power_profiler.start_phase(Power_Phase::blink);
   pinMode(PIN_STAT_LED, OUTPUT);
   for (int i=0; i<3; i++){
     digitalWrite(PIN_STAT_LED, HIGH);
@@ -172,18 +183,28 @@ void loop()
     delay(200);
   }
   pinMode(PIN_STAT_LED, INPUT);
+  power_profiler.stop_phase(Power_Phase::blink);
 
+  power_profiler.start_phase(Power_Phase::gnss);
   gnss_manager.get_a_fix();
+  power_profiler.stop_phase(Power_Phase::gnss);
 
+  power_profiler.start_phase(Power_Phase::thermistors);
   board_thermistors_manager.start();
   board_thermistors_manager.perform_time_acquisition();
   board_thermistors_manager.stop();
+  power_profiler.stop_phase(Power_Phase::thermistors);
 
+  power_profiler.start_phase(Power_Phase::mlx);
   mlx90164_manager.acquire_n_readings();
+  power_profiler.stop_phase(Power_Phase::mlx);
 
+  power_profiler.start_phase(Power_Phase::sd_logging);
   sd_manager_instance.update_filename();
   sd_manager_instance.log_data();
+  power_profiler.stop_phase(Power_Phase::sd_logging);
 
+  power_profiler.start_phase(Power_Phase::blink);
     pinMode(PIN_STAT_LED, OUTPUT);
   for (int i=0; i<4; i++){
     digitalWrite(PIN_STAT_LED, HIGH);
@@ -192,6 +213,9 @@ void loop()
     delay(200);
   }
   pinMode(PIN_STAT_LED, INPUT);
+  power_profiler.stop_phase(Power_Phase::blink);
+
+  power_profiler.end_wakeup();
 
   sleep_for_seconds(15 * 60);
 }
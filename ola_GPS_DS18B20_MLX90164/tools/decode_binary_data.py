@@ -0,0 +1,300 @@
+"""Decode the binary blocks written by the logger (see lib/binary_format/binary_format.h).
+
+Each binary block is turned back into the same text sections as the ones written by the
+ASCII logging mode of the firmware, so that the existing data analysis scripts can be used
+on the decoded files.
+
+Usage:
+
+python3 decode_binary_data.py FILE.bin [FILE.bin ...]
+
+writes FILE.dat next to each FILE.bin; use --stdout to print to the terminal instead.
+"""
+
+import argparse
+import math
+import struct
+import sys
+import zlib
+from pathlib import Path
+
+BLOCK_MAGIC = b"OLAD"
+SUPPORTED_FORMAT_VERSIONS = (1, 2, 3)
+
+# struct formats, little endian, packed; must match binary_format.h
+BLOCK_HEADER_FORMAT = "<4sHHIQ40sHH"
+BLOCK_HEADER_SIZE = struct.calcsize(BLOCK_HEADER_FORMAT)
+SECTION_HEADER_FORMAT = "<HHI"
+SECTION_HEADER_SIZE = struct.calcsize(SECTION_HEADER_FORMAT)
+CRC_SIZE = 4
+BLOCK_ALIGNMENT = 512
+
+SECTION_THERMISTORS = 1
+SECTION_MLX = 2
+SECTION_POWER_PROFILE = 3
+SECTION_THERMISTOR_STATISTICS = 4
+SECTION_TRACE = 5
+
+BLOCK_TYPE_DATA = 0
+BLOCK_TYPE_BOOT = 1
+
+THERMISTOR_RECORD_FORMAT = "<Qh"
+MLX_RECORD_FORMAT = "<Iff"
+POWER_PROFILE_RECORD_FORMAT = "<B3xIIII"
+
+# the record formats that changed between format versions: {(format_version, section_type): format}
+LEGACY_RECORD_FORMATS = {
+    (1, SECTION_THERMISTORS): "<Qf",  # float celsius instead of raw 1/16 celsius
+}
+THERMISTOR_STATISTICS_RECORD_FORMAT = "<QIiqhhI"
+TRACE_RECORD_FORMAT = "<IHHI"
+
+# the names of the power profiler statistics, by index; must match power_profiler.cpp
+POWER_PROFILE_NAMES = (
+    "blink", "gnss", "thermistors", "mlx", "sd_logging",
+    "qwiic_on", "ds18b20_on", "sd_on", "awake", "cycle_s", "sd_busy",
+)
+
+# the names of the trace log events, by id; must match trace_log.cpp
+TRACE_EVENT_NAMES = (
+    "boot", "sleep", "wakeup",
+    "gnss_start_failed", "gnss_reboot", "gnss_fix", "gnss_timeout",
+    "thermistors_scan", "thermistors_conversion", "thermistors_conversion_timeout", "thermistors_crc_error",
+    "mlx_start_failed", "mlx_read_failed",
+    "sd_start_failed", "sd_busy_timeout", "sd_write_error", "sd_block_written",
+    "gnss_assistance",
+    "mlx_hardware_i2c_fallback",
+    "heap_allocation",
+    "sd_block_too_large",
+)
+
+assert BLOCK_HEADER_SIZE == 64
+assert SECTION_HEADER_SIZE == 8
+
+
+class DecodingError(Exception):
+    pass
+
+
+def format_float(value):
+    """Format a float the same way as the Arduino Print::print(float), i.e. 2 decimals."""
+    return f"{value:.2f}"
+
+
+def format_sixteenths(raw):
+    """Format a raw 1/16 celsius value the same way as print_sixteenths_to_serial_print_buff; exact."""
+    return f"{raw / 16.0:.4f}"
+
+
+def record_format(section_type, format_version):
+    record_format_current, _ = SECTION_DECODERS[section_type]
+    return LEGACY_RECORD_FORMATS.get((format_version, section_type), record_format_current)
+
+
+def decode_thermistors_section(payload, number_of_records, record_size, header):
+    lines = ["THERMISTORS_START"]
+    lines.append(f"THERMISTORS_POSIX_TIME_START: {header['posix_start']}")
+    lines.append("READING_NBR,THERMISTOR_ID,CELCIUS,")
+    for ind in range(number_of_records):
+        crrt_id, crrt_reading = struct.unpack_from(record_format(SECTION_THERMISTORS, header["format_version"]),
+                                                   payload, ind * record_size)
+        if header["format_version"] == 1:
+            lines.append(f"{ind},{crrt_id},{format_float(crrt_reading)},")
+        else:
+            lines.append(f"{ind},{crrt_id},{format_sixteenths(crrt_reading)},")
+    lines.append("THERMISTORS_STOP\n")
+    return lines
+
+
+def decode_thermistor_statistics_section(payload, number_of_records, record_size, header):
+    lines = ["THERMISTORS_STATISTICS_START"]
+    lines.append("THERMISTOR_ID,COUNT,MEAN_CELCIUS,STD_CELCIUS,MIN_CELCIUS,MAX_CELCIUS,CRC_FAILURES,")
+    for ind in range(number_of_records):
+        (crrt_id, count, sum_raw, sum_squares_raw, min_raw, max_raw,
+         crc_failures) = struct.unpack_from(THERMISTOR_STATISTICS_RECORD_FORMAT, payload, ind * record_size)
+        if count > 0:
+            mean = sum_raw / count / 16.0
+            std = math.sqrt(max(count * sum_squares_raw - sum_raw * sum_raw, 0)) / count / 16.0
+        else:
+            mean = std = math.nan
+        lines.append(f"{crrt_id},{count},{mean:.4f},{std:.4f},{format_sixteenths(min_raw)},{format_sixteenths(max_raw)},{crc_failures},")
+    lines.append("THERMISTORS_STATISTICS_STOP\n")
+    return lines
+
+
+def decode_mlx_section(payload, number_of_records, record_size, header):
+    lines = ["IRSENSOR_START"]
+    lines.append("READING_NBR,POSIX_TIMESTAMP,IR_TEMP,SENSOR_TEMP,")
+    for ind in range(number_of_records):
+        posix_timestamp, ir_temperature, sensor_temperature = struct.unpack_from(MLX_RECORD_FORMAT, payload, ind * record_size)
+        lines.append(f"{ind},{posix_timestamp},{format_float(ir_temperature)},{format_float(sensor_temperature)},")
+    lines.append("IRSENSOR_STOP\n")
+    return lines
+
+
+def decode_power_profile_section(payload, number_of_records, record_size, header):
+    lines = ["POWER_PROFILE_START"]
+    lines.append("NAME,LAST,COUNT,MEAN,MAX,")
+    for ind in range(number_of_records):
+        statistics_index, last, count, mean, maximum = struct.unpack_from(POWER_PROFILE_RECORD_FORMAT, payload, ind * record_size)
+        if statistics_index < len(POWER_PROFILE_NAMES):
+            name = POWER_PROFILE_NAMES[statistics_index]
+        else:
+            name = f"unknown_{statistics_index}"
+        lines.append(f"{name},{last},{count},{mean},{maximum},")
+    lines.append("POWER_PROFILE_STOP\n")
+    return lines
+
+
+def decode_trace_section(payload, number_of_records, record_size, header):
+    lines = ["TRACE_START"]
+    lines.append("RECORD_NBR,BOOT_NUMBER,POSIX_TIMESTAMP,EVENT,ARG,")
+    for ind in range(number_of_records):
+        posix_timestamp, boot_number, event, arg = struct.unpack_from(TRACE_RECORD_FORMAT, payload, ind * record_size)
+        if event < len(TRACE_EVENT_NAMES):
+            name = TRACE_EVENT_NAMES[event]
+        else:
+            name = "unknown"
+        lines.append(f"{ind},{boot_number},{posix_timestamp},{name},{arg},")
+    lines.append("TRACE_STOP\n")
+    return lines
+
+
+SECTION_DECODERS = {
+    SECTION_THERMISTORS: (THERMISTOR_RECORD_FORMAT, decode_thermistors_section),
+    SECTION_MLX: (MLX_RECORD_FORMAT, decode_mlx_section),
+    SECTION_THERMISTOR_STATISTICS: (THERMISTOR_STATISTICS_RECORD_FORMAT, decode_thermistor_statistics_section),
+    SECTION_POWER_PROFILE: (POWER_PROFILE_RECORD_FORMAT, decode_power_profile_section),
+    SECTION_TRACE: (TRACE_RECORD_FORMAT, decode_trace_section),
+}
+
+
+def decode_block_header(data, offset):
+    (magic, format_version, boot_number, block_length, posix_start,
+     firmware_commit, number_of_sections, block_type) = struct.unpack_from(BLOCK_HEADER_FORMAT, data, offset)
+
+    return {
+        "magic": magic,
+        "format_version": format_version,
+        "boot_number": boot_number,
+        "block_length": block_length,
+        "posix_start": posix_start,
+        "firmware_commit": firmware_commit.rstrip(b"\x00").decode("ascii", errors="replace"),
+        "number_of_sections": number_of_sections,
+        "block_type": block_type,
+    }
+
+
+def decode_block(data, offset):
+    """Decode the block starting at offset; return (list of text lines, block length)."""
+    header = decode_block_header(data, offset)
+
+    if header["format_version"] not in SUPPORTED_FORMAT_VERSIONS:
+        raise DecodingError(f"unsupported format version {header['format_version']} at offset {offset}")
+
+    block_length = header["block_length"]
+    if offset + block_length > len(data) or block_length < BLOCK_HEADER_SIZE + CRC_SIZE:
+        raise DecodingError(f"truncated or invalid block at offset {offset}")
+
+    block = data[offset:offset + block_length]
+    (crc_expected,) = struct.unpack_from("<I", block, block_length - CRC_SIZE)
+    if zlib.crc32(block[:-CRC_SIZE]) != crc_expected:
+        raise DecodingError(f"CRC mismatch in block at offset {offset}")
+
+    # before version 3, a boot block was a block with no sections
+    if header["format_version"] < 3:
+        is_boot_block = header["number_of_sections"] == 0
+    else:
+        is_boot_block = header["block_type"] == BLOCK_TYPE_BOOT
+
+    if is_boot_block:
+        lines = ["", "", "BOOT", ""]
+    else:
+        lines = ["", "", "DATA-start", ""]
+
+    section_offset = BLOCK_HEADER_SIZE
+    for _ in range(header["number_of_sections"]):
+        section_type, record_size, number_of_records = struct.unpack_from(SECTION_HEADER_FORMAT, block, section_offset)
+        section_offset += SECTION_HEADER_SIZE
+        payload = block[section_offset:section_offset + record_size * number_of_records]
+        section_offset += record_size * number_of_records
+
+        if section_type not in SECTION_DECODERS:
+            lines.append(f"UNKNOWN_SECTION_{section_type}_SKIPPED")
+            continue
+
+        _, section_decoder = SECTION_DECODERS[section_type]
+        if struct.calcsize(record_format(section_type, header["format_version"])) != record_size:
+            raise DecodingError(f"unexpected record size {record_size} for section {section_type}")
+
+        lines.extend(section_decoder(payload, number_of_records, record_size, header))
+
+    if is_boot_block:
+        lines.extend(["BOOT_done", ""])
+    else:
+        lines.append("DATA-stop\n")
+
+    return lines, block_length
+
+
+def decode_file(path):
+    """Decode all the blocks in a binary file; return the text content."""
+    data = Path(path).read_bytes()
+
+    lines = []
+    offset = 0
+    first_boot_number = None
+    while offset + BLOCK_HEADER_SIZE <= len(data):
+        if data[offset:offset + len(BLOCK_MAGIC)] != BLOCK_MAGIC:
+            # nothing more was written to this file
+            break
+
+        # a file only holds the blocks of one boot; the preallocation does not erase the
+        # clusters, so past these, there may be stale blocks of a deleted file
+        boot_number = decode_block_header(data, offset)["boot_number"]
+        if first_boot_number is None:
+            first_boot_number = boot_number
+        elif boot_number != first_boot_number:
+            break
+
+        try:
+            block_lines, block_length = decode_block(data, offset)
+        except DecodingError as e:
+            if not lines:
+                raise
+            # typically a power loss during the last write; keep the blocks before it
+            print(f"{path}: {e}; keeping the blocks decoded so far", file=sys.stderr)
+            break
+
+        lines.extend(block_lines)
+        offset += block_length
+
+        # blocks start on sector boundaries, with zero padding in between; the very first
+        # firmware versions wrote blocks back to back, so accept both
+        if data[offset:offset + len(BLOCK_MAGIC)] != BLOCK_MAGIC:
+            offset = -(-offset // BLOCK_ALIGNMENT) * BLOCK_ALIGNMENT
+
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("files", nargs="+", type=Path)
+    parser.add_argument("--stdout", action="store_true", help="print to stdout instead of writing .dat files")
+    args = parser.parse_args()
+
+    for crrt_file in args.files:
+        try:
+            content = decode_file(crrt_file)
+        except DecodingError as e:
+            print(f"{crrt_file}: {e}", file=sys.stderr)
+            continue
+
+        if args.stdout:
+            sys.stdout.write(content)
+        else:
+            crrt_file.with_suffix(".dat").write_text(content)
+
+
+if __name__ == "__main__":
+    main()